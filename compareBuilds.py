@@ -0,0 +1,61 @@
+import math
+import os
+import resource
+import subprocess
+import sys
+
+# Compares the specialized solver ('make') with the generic one ('make generic') on every
+# CNF file of a directory. Each file is solved 'repetitions' times by both executables in
+# turn, and the lowest CPU time (user and system) of each is reported.
+
+repetitions = 3
+
+def cpuTime():
+    usage = resource.getrusage(resource.RUSAGE_CHILDREN)
+    return usage.ru_utime + usage.ru_stime
+
+def runOnce(exe, path, args):
+    start = cpuTime()
+    result = subprocess.run(["./" + exe, path] + args, capture_output=True, text=True, timeout = 600)
+    elapsed = cpuTime() - start
+    output = result.stdout.strip().split()
+    return elapsed, output[1] if len(output) > 1 else "ERROR"
+
+def compareAll(specialized, generic, dir, args):
+    files = sorted(f for f in os.listdir(dir) if f.endswith(".cnf"))
+    totals = [0.0, 0.0]
+    logRatios = []
+    print("%-40s %12s %12s %8s" % ("FILE", "SPECIALIZED", "GENERIC", "RATIO"))
+    for filename in files:
+        path = dir + "/" + filename
+        best = [float("inf"), float("inf")]
+        answers = set()
+        try:
+            for _ in range(repetitions):
+                for index, exe in enumerate([specialized, generic]):
+                    elapsed, answer = runOnce(exe, path, args)
+                    best[index] = min(best[index], elapsed)
+                    answers.add(answer)
+        except subprocess.TimeoutExpired:
+            print("%-40s TIMEOUT" % filename)
+            continue
+        if len(answers) != 1:
+            print("%-40s DIFFERENT ANSWERS %s" % (filename, " ".join(sorted(answers))))
+            continue
+        totals[0] += best[0]
+        totals[1] += best[1]
+        logRatios.append(math.log(best[1] / best[0]))
+        print("%-40s %12.3f %12.3f %8.3f" % (filename, best[0], best[1], best[1] / best[0]))
+    if logRatios:
+        print("%-40s %12.3f %12.3f %8.3f" % ("TOTAL", totals[0], totals[1], totals[1] / totals[0]))
+        print("Geometric mean of generic / specialized time: %.3f" % math.exp(sum(logRatios) / len(logRatios)))
+
+def main(argv):
+    if len(argv) < 5:
+        print(argv[0], " <specialized executable> <generic executable> <directory of cnf files> <heuristic> [options]")
+        sys.exit(2)
+    else:
+        compareAll(argv[1], argv[2], argv[3], argv[4:])
+
+if __name__ == "__main__":
+    main(sys.argv)
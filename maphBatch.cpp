@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "maphBatch.hpp"
+#include "maphDimacs.hpp"
+
+namespace {
+
+// Write all of 'text' to a file descriptor. A peer that has gone away loses its results.
+void writeAll(int output, const std::string & text) {
+    std::size_t written = 0;
+    while (written < text.size()) {
+        const ssize_t size = ::write(output, text.data() + written, text.size() - written);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            return;
+        written += size;
+    }
+}
+
+// Reads a file descriptor through a buffer.
+class Reader {
+
+    int input;
+    std::vector<char> buffer;
+    std::size_t position;
+    std::size_t end;
+
+    bool refill() {
+        ssize_t size;
+        do {
+            size = ::read(input, buffer.data(), buffer.size());
+        } while (size < 0 && errno == EINTR);
+        position = 0;
+        end = size > 0 ? size : 0;
+        return end > 0;
+    }
+
+public:
+
+    explicit Reader(int input) : input(input), buffer(1 << 16), position(0), end(0) {}
+
+    // Returns the next byte, or -1 at the end of the input.
+    int get() {
+        if (position == end && !refill())
+            return -1;
+        return static_cast<unsigned char>(buffer[position++]);
+    }
+
+    // Read exactly 'size' bytes into 'text'. Returns false if the input ends before. The text
+    // grows with the bytes that arrive rather than with the size the peer announced.
+    bool read(std::string & text, std::size_t size) {
+        text.clear();
+        while (text.size() < size) {
+            if (position == end && !refill())
+                return false;
+            const std::size_t chunk = std::min(size - text.size(), end - position);
+            text.append(buffer.data() + position, chunk);
+            position += chunk;
+        }
+        return true;
+    }
+};
+
+}
+
+constexpr std::size_t BatchSolver::maximumLength;
+
+BatchSolver::BatchSolver(MaphSAT::Heuristic heuristic, const MaphSAT::Options & options, std::size_t numberThreads) :
+    heuristic(heuristic), options(options), openJobs(0), numberJobs(0), stopping(false) {
+    for (std::size_t thread = 0; thread < numberThreads; ++thread)
+        workers.emplace_back(&BatchSolver::work, this);
+}
+
+BatchSolver::~BatchSolver() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobAdded.notify_all();
+    for (std::thread & worker : workers)
+        worker.join();
+}
+
+void BatchSolver::submit(std::string path, std::string text, int output) {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back({++numberJobs, std::move(path), std::move(text), output});
+        ++openJobs;
+    }
+    jobAdded.notify_one();
+}
+
+void BatchSolver::wait() {
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    jobDone.wait(lock, [this] { return openJobs == 0; });
+}
+
+void BatchSolver::work() {
+    MaphSAT solver(heuristic, options);
+    while (true) {
+        std::unique_lock<std::mutex> lock(jobsMutex);
+        jobAdded.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+            return;
+        const Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        solve(solver, job);
+
+        lock.lock();
+        --openJobs;
+        lock.unlock();
+        jobDone.notify_all();
+    }
+}
+
+// Solve a job and write its result line. The time includes parsing.
+void BatchSolver::solve(MaphSAT & solver, const Job & job) {
+    const auto start = std::chrono::steady_clock::now();
+    const char * status = "ERROR";
+    try {
+        bool loaded = false;
+        if (!job.path.empty()) {
+            DimacsParser parser(job.path.c_str());
+            if (parser.isOpen()) {
+                solver.load(parser);
+                loaded = true;
+            }
+        } else {
+            DimacsParser parser(job.text.data(), job.text.size());
+            solver.load(parser);
+            loaded = true;
+        }
+        if (loaded) {
+            const bool satisfiable = solver.solve();
+            status = satisfiable ? "SATISFIABLE" : solver.isSolved() ? "UNSATISFIABLE" : "UNKNOWN";
+        }
+    } catch (const std::exception &) {
+        // A malformed formula, or one too large for the memory. An exception must not
+        // escape the worker thread, which would terminate the process.
+        status = "ERROR";
+    }
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    std::ostringstream line;
+    line << job.number << ' ' << status << ' ' << std::fixed << std::setprecision(6) << time.count() << ' '
+         << (job.path.empty() ? "-" : job.path) << '\n';
+    std::lock_guard<std::mutex> lock(outputMutex);
+    writeAll(job.output, line.str());
+}
+
+void BatchSolver::solveList(std::istream & list, int output) {
+    std::string path;
+    while (std::getline(list, path)) {
+        if (!path.empty() && path.back() == '\r')
+            path.pop_back();
+        if (!path.empty())
+            submit(path, std::string(), output);
+    }
+    wait();
+}
+
+// Each job is a line with the length of its DIMACS text in bytes, followed by the text.
+// Whitespace between jobs is skipped. A length above 'maximumLength' makes the input malformed.
+bool BatchSolver::serve(int input, int output) {
+    Reader reader(input);
+    bool wellFormed = true;
+    std::string text;
+    while (true) {
+        int c = reader.get();
+        while (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            c = reader.get();
+        if (c == -1)
+            break;
+
+        std::size_t length = 0;
+        bool tooLong = false;
+        while (c >= '0' && c <= '9') {
+            if (length > (maximumLength - (c - '0')) / 10)
+                tooLong = true;
+            else
+                length = 10 * length + (c - '0');
+            c = reader.get();
+        }
+        if (c == '\r')
+            c = reader.get();
+        if (c != '\n' || tooLong || !reader.read(text, length)) {
+            wellFormed = false;
+            break;
+        }
+        submit(std::string(), text, output);
+    }
+    wait();
+    return wellFormed;
+}
+
+bool BatchSolver::listen(const char * path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(address.sun_path))
+        return false;
+    std::strcpy(address.sun_path, path);
+
+    // A socket left behind by an earlier server is replaced, but any other file at the path is kept.
+    struct stat status;
+    if (lstat(path, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode) || unlink(path) != 0)
+            return false;
+    }
+
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0)
+        return false;
+    if (bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(server, 16) != 0) {
+        close(server);
+        return false;
+    }
+    // A client that disconnects early must not terminate the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    while (true) {
+        const int connection = accept(server, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        serve(connection, connection);
+        close(connection);
+    }
+    close(server);
+    return false;
+}
@@ -0,0 +1,94 @@
+#ifndef __MAPHBATCH_HPP__
+#define __MAPHBATCH_HPP__
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maphSat.hpp"
+
+// Solves many formulas in one long-lived process. Jobs are the paths of DIMACS files, or
+// DIMACS texts sent on a stream, each preceded by a line with its length in bytes. A pool
+// of worker threads solves the jobs in the order they arrive. Each worker keeps one solver
+// and loads every job into it, so the memory of its clause arena, trail and watch lists
+// is reused. For every job one line is written:
+//
+//     <job number> <SATISFIABLE | UNSATISFIABLE | UNKNOWN | ERROR> <seconds> <path>
+//
+// The path of a job sent on a stream is '-'. Jobs are numbered from 1 in the order they
+// arrive. When several workers run, the lines are written in the order the jobs finish.
+class BatchSolver {
+
+    struct Job {
+        std::size_t number;
+        // The path of a DIMACS file, or empty for a job sent on a stream.
+        std::string path;
+        // The DIMACS text of a job sent on a stream.
+        std::string text;
+        // The file descriptor the result line is written to.
+        int output;
+    };
+
+    MaphSAT::Heuristic heuristic;
+    MaphSAT::Options options;
+
+    std::vector<std::thread> workers;
+
+    // The jobs waiting for a worker, and the number of jobs queued or being solved.
+    std::deque<Job> jobs;
+    std::size_t openJobs;
+    std::size_t numberJobs;
+    bool stopping;
+    std::mutex jobsMutex;
+    std::condition_variable jobAdded;
+    std::condition_variable jobDone;
+
+    // Serializes the result lines of different workers.
+    std::mutex outputMutex;
+
+    // The longest DIMACS text accepted on a stream, in bytes.
+    static constexpr std::size_t maximumLength = std::size_t(1) << 30;
+
+    void submit(std::string path, std::string text, int output);
+
+    // Wait until every submitted job has been solved.
+    void wait();
+
+    // Take jobs from the queue and solve them until the pool is stopped.
+    void work();
+
+    // Solve a job with the solver of the worker.
+    void solve(MaphSAT & solver, const Job & job);
+
+public:
+
+    // Start 'numberThreads' workers that solve each job with the given heuristic and options.
+    BatchSolver(MaphSAT::Heuristic heuristic, const MaphSAT::Options & options, std::size_t numberThreads);
+
+    // Finish the queued jobs and stop the workers.
+    ~BatchSolver();
+
+    BatchSolver(const BatchSolver &) = delete;
+    BatchSolver & operator=(const BatchSolver &) = delete;
+
+    // Solve the DIMACS files whose paths are listed in 'list', one per line, and write the
+    // results to the file descriptor 'output'. Empty lines are skipped.
+    void solveList(std::istream & list, int output);
+
+    // Solve the length-prefixed DIMACS texts read from the file descriptor 'input' until it
+    // is closed, and write the results to 'output'. Returns false if the input is malformed,
+    // which includes a text longer than 'maximumLength'.
+    bool serve(int input, int output);
+
+    // Listen on a Unix socket at 'path' and serve each connection in turn, writing the results
+    // back to the connection. A socket left at 'path' is replaced. Returns false if the socket
+    // cannot be set up, or if another kind of file exists at 'path'.
+    bool listen(const char * path);
+};
+
+#endif
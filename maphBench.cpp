@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "maphBench.hpp"
+#include "maphDimacs.hpp"
+
+namespace {
+
+// What a child process reports about its run. The CPU time and the peak memory are taken
+// from the resource usage of the child.
+struct Measurement {
+    enum Status { SATISFIABLE, UNSATISFIABLE, UNKNOWN, WRONG, ERROR } status;
+    double parse;
+    double preprocess;
+    double propagate;
+    double analyze;
+    double decide;
+    double wall;
+};
+
+const char * statusName(Measurement::Status status) {
+    switch (status) {
+    case Measurement::SATISFIABLE:
+        return "SATISFIABLE";
+    case Measurement::UNSATISFIABLE:
+        return "UNSATISFIABLE";
+    case Measurement::UNKNOWN:
+        return "UNKNOWN";
+    case Measurement::WRONG:
+        return "WRONG";
+    case Measurement::ERROR:
+        break;
+    }
+    return "ERROR";
+}
+
+bool isSolved(const std::string & status) {
+    return status == "SATISFIABLE" || status == "UNSATISFIABLE";
+}
+
+// Orders the statuses from the best to the worst outcome.
+int severity(const std::string & status) {
+    return isSolved(status) ? 0 : status == "UNKNOWN" ? 1 : status == "WRONG" ? 2 : 3;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Does the model of the solver satisfy every clause of the formula?
+bool satisfies(const MaphSAT & solver, const Formula & formula) {
+    for (Literal unit : formula.units) {
+        if (!solver.modelValue(toDimacs(unit)))
+            return false;
+    }
+    for (ClauseRef ref : formula.clauses) {
+        const auto clause = formula.arena[ref];
+        if (std::none_of(clause.begin(), clause.end(), [&solver](Literal literal) {
+                return solver.modelValue(toDimacs(literal));
+            }))
+            return false;
+    }
+    return true;
+}
+
+// Parse and solve a file, interrupting the solver after 'timeout' seconds. Runs in the child process.
+Measurement solve(const std::string & path, const Benchmark::Configuration & configuration, double timeout) {
+    Measurement measurement = {Measurement::ERROR, 0, 0, 0, 0, 0, 0};
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        DimacsParser parser(path.c_str());
+        if (!parser.isOpen())
+            return measurement;
+        Formula formula;
+        parser.read(formula);
+        measurement.parse = secondsSince(start);
+
+        MaphSAT::Options options = configuration.options;
+        options.timePhases = true;
+        MaphSAT solver(formula, configuration.heuristic, options);
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        std::thread watchdog([&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!finished.wait_for(lock, std::chrono::duration<double>(timeout), [&done] { return done; }))
+                solver.interrupt();
+        });
+        const bool satisfiable = solver.solve();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        finished.notify_one();
+        watchdog.join();
+
+        measurement.wall = secondsSince(start);
+        const MaphSAT::PhaseTimes & times = solver.phaseTimes();
+        measurement.preprocess = times.preprocess;
+        measurement.propagate = times.propagate;
+        measurement.analyze = times.analyze;
+        measurement.decide = times.decide;
+        if (satisfiable)
+            measurement.status = satisfies(solver, formula) ? Measurement::SATISFIABLE : Measurement::WRONG;
+        else
+            measurement.status = solver.isSolved() ? Measurement::UNSATISFIABLE : Measurement::UNKNOWN;
+    } catch (const std::exception &) {
+        measurement.status = Measurement::ERROR;
+    }
+    return measurement;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t middle = values.size() / 2;
+    return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Quote a CSV field if it contains a separator, a quote or a line break.
+std::string csvField(const std::string & text) {
+    if (text.find_first_of(",\"\n") == std::string::npos)
+        return text;
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+// Split a CSV line into its fields. Returns false if a quoted field is not closed.
+bool splitCsv(const std::string & line, std::vector<std::string> & fields) {
+    fields.assign(1, std::string());
+    bool quoted = false;
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+            fields.back() += line[++i];
+        else if (c == '"')
+            quoted = !quoted;
+        else if (c == ',' && !quoted)
+            fields.emplace_back();
+        else
+            fields.back() += c;
+    }
+    return !quoted;
+}
+
+std::string jsonString(const std::string & text) {
+    std::ostringstream out;
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        else
+            out << c;
+    }
+    out << '"';
+    return out.str();
+}
+
+const char * const csvHeader = "suite,file,configuration,status,parse,preprocess,propagate,analyze,decide,wall,cpu,peak_rss_kb";
+
+}
+
+Benchmark::Benchmark(const std::vector<std::string> & suites, const std::vector<Configuration> & configurations,
+    std::size_t warmups, std::size_t repetitions, double timeout) :
+    suites(suites), configurations(configurations), warmups(warmups), repetitions(std::max<std::size_t>(repetitions, 1)),
+    timeout(timeout) {}
+
+std::vector<std::string> Benchmark::listFiles(const std::string & suite) {
+    std::vector<std::string> files;
+    DIR * directory = opendir(suite.c_str());
+    if (directory == nullptr)
+        return files;
+    while (const dirent * entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        for (const char * extension : {".cnf", ".cnf.gz", ".cnf.xz", ".cnf.bz2"}) {
+            const std::size_t length = std::strlen(extension);
+            if (name.size() > length && name.compare(name.size() - length, length, extension) == 0) {
+                files.push_back(name);
+                break;
+            }
+        }
+    }
+    closedir(directory);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// The child writes its measurement to a pipe and exits. A child that crashes or is killed by
+// the alarm, which backs up the watchdog in case parsing takes too long, writes nothing.
+Benchmark::Result Benchmark::run(const std::string & path, const Configuration & configuration) const {
+    Result result = {std::string(), std::string(), configuration.name, "ERROR", 0, 0, 0, 0, 0, 0, 0, 0};
+    int channel[2];
+    if (pipe(channel) != 0)
+        return result;
+
+    const pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return result;
+    }
+    if (child == 0) {
+        close(channel[0]);
+        alarm(static_cast<unsigned>(2 * timeout) + 10);
+        const Measurement measurement = solve(path, configuration, timeout);
+        const char * data = reinterpret_cast<const char *>(&measurement);
+        std::size_t written = 0;
+        while (written < sizeof(measurement)) {
+            const ssize_t size = ::write(channel[1], data + written, sizeof(measurement) - written);
+            if (size < 0 && errno == EINTR)
+                continue;
+            if (size <= 0)
+                break;
+            written += size;
+        }
+        _exit(0);
+    }
+
+    close(channel[1]);
+    Measurement measurement;
+    char * data = reinterpret_cast<char *>(&measurement);
+    std::size_t received = 0;
+    while (received < sizeof(measurement)) {
+        const ssize_t size = ::read(channel[0], data + received, sizeof(measurement) - received);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            break;
+        received += size;
+    }
+    close(channel[0]);
+
+    int status;
+    rusage usage;
+    while (wait4(child, &status, 0, &usage) < 0 && errno == EINTR);
+    result.cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    result.peakMemory = usage.ru_maxrss;
+    if (received < sizeof(measurement) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return result;
+
+    result.status = statusName(measurement.status);
+    result.parse = measurement.parse;
+    result.preprocess = measurement.preprocess;
+    result.propagate = measurement.propagate;
+    result.analyze = measurement.analyze;
+    result.decide = measurement.decide;
+    result.wall = measurement.wall;
+    return result;
+}
+
+// The result of a file and a configuration combines its repetitions. The status is the worst
+// of them, and repetitions that disagree on the answer make it WRONG.
+void Benchmark::run(std::ostream & progress) {
+    for (const std::string & suite : suites) {
+        for (const std::string & file : listFiles(suite)) {
+            const std::string path = suite + "/" + file;
+            for (const Configuration & configuration : configurations) {
+                for (std::size_t warmup = 0; warmup < warmups; ++warmup)
+                    run(path, configuration);
+
+                std::vector<Result> runs;
+                for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+                    runs.push_back(run(path, configuration));
+
+                Result result = runs.front();
+                result.suite = suite;
+                result.file = file;
+                std::vector<double> values(runs.size());
+                for (auto field : {&Result::parse, &Result::preprocess, &Result::propagate, &Result::analyze,
+                                   &Result::decide, &Result::wall, &Result::cpu}) {
+                    std::transform(runs.begin(), runs.end(), values.begin(), [field](const Result & r) { return r.*field; });
+                    result.*field = median(values);
+                }
+                for (const Result & repetition : runs) {
+                    result.peakMemory = std::max(result.peakMemory, repetition.peakMemory);
+                    if (isSolved(result.status) && isSolved(repetition.status) && result.status != repetition.status)
+                        result.status = "WRONG";
+                    else if (severity(repetition.status) > severity(result.status))
+                        result.status = repetition.status;
+                }
+                results.push_back(result);
+
+                const char * tag = isSolved(result.status) ? "[OK]" : result.status == "UNKNOWN" ? "[TIMEOUT]" : "[FAIL]";
+                progress << tag << ' ' << result.status << ' ' << std::fixed << std::setprecision(3) << result.cpu
+                         << std::defaultfloat << ' ' << path << " (" << configuration.name << ")" << std::endl;
+            }
+        }
+    }
+}
+
+void Benchmark::writeJson(std::ostream & out) const {
+    out << "{\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result & result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << std::fixed << std::setprecision(6)
+            << "    {\"suite\": " << jsonString(result.suite) << ", \"file\": " << jsonString(result.file)
+            << ", \"configuration\": " << jsonString(result.configuration) << ", \"status\": " << jsonString(result.status)
+            << ", \"parse\": " << result.parse << ", \"preprocess\": " << result.preprocess
+            << ", \"propagate\": " << result.propagate << ", \"analyze\": " << result.analyze
+            << ", \"decide\": " << result.decide << ", \"wall\": " << result.wall << ", \"cpu\": " << result.cpu
+            << ", \"peak_rss_kb\": " << result.peakMemory << "}";
+    }
+    out << "\n  ]\n}\n" << std::defaultfloat;
+}
+
+void Benchmark::writeCsv(std::ostream & out) const {
+    out << csvHeader << '\n' << std::fixed << std::setprecision(6);
+    for (const Result & result : results) {
+        out << csvField(result.suite) << ',' << csvField(result.file) << ',' << csvField(result.configuration) << ','
+            << result.status << ',' << result.parse << ',' << result.preprocess << ',' << result.propagate << ','
+            << result.analyze << ',' << result.decide << ',' << result.wall << ',' << result.cpu << ','
+            << result.peakMemory << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+bool Benchmark::readCsv(std::istream & in, std::vector<Result> & baseline) {
+    std::string line;
+    if (!std::getline(in, line) || line != csvHeader)
+        return false;
+    std::vector<std::string> fields;
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+        if (!splitCsv(line, fields) || fields.size() != 12)
+            return false;
+        try {
+            baseline.push_back({fields[0], fields[1], fields[2], fields[3], std::stod(fields[4]), std::stod(fields[5]),
+                std::stod(fields[6]), std::stod(fields[7]), std::stod(fields[8]), std::stod(fields[9]),
+                std::stod(fields[10]), std::stol(fields[11])});
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t Benchmark::compare(const std::vector<Result> & baseline, double threshold, double minimumSeconds,
+    long minimumKilobytes, std::ostream & out) const {
+    std::map<std::string, const Result *> previous;
+    for (const Result & result : baseline)
+        previous[result.suite + '\n' + result.file + '\n' + result.configuration] = &result;
+
+    std::size_t regressions = 0;
+    for (const Result & result : results) {
+        const auto found = previous.find(result.suite + '\n' + result.file + '\n' + result.configuration);
+        if (found == previous.end())
+            continue;
+        const Result & old = *found->second;
+        const std::string name = result.suite + "/" + result.file + " (" + result.configuration + ")";
+
+        std::ostringstream reason;
+        reason << std::fixed << std::setprecision(3);
+        if (isSolved(result.status) && isSolved(old.status) && result.status != old.status)
+            reason << "answer changed from " << old.status << " to " << result.status;
+        else if (severity(result.status) > severity(old.status))
+            reason << "status changed from " << old.status << " to " << result.status;
+        else if (isSolved(result.status) && result.cpu > old.cpu * (1 + threshold) && result.cpu - old.cpu > minimumSeconds)
+            reason << "CPU time rose from " << old.cpu << " s to " << result.cpu << " s";
+        else if (result.peakMemory > old.peakMemory * (1 + threshold) && result.peakMemory - old.peakMemory > minimumKilobytes)
+            reason << "peak memory rose from " << old.peakMemory << " kB to " << result.peakMemory << " kB";
+        else
+            continue;
+        out << "REGRESSION " << name << ": " << reason.str() << '\n';
+        ++regressions;
+    }
+    return regressions;
+}
@@ -0,0 +1,86 @@
+#ifndef __MAPHBENCH_HPP__
+#define __MAPHBENCH_HPP__
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "maphSat.hpp"
+
+// Solves the CNF files of a number of directories (suites) with every configuration of a
+// matrix of heuristics and options, and measures each phase of solving. Every run takes
+// place in a child process, so that its peak resident set size is its own and a crashing
+// run cannot take the benchmark down with it.
+class Benchmark {
+
+public:
+
+    // A heuristic with solver options. Its name is the heuristic followed by the options as
+    // they are given on the command line.
+    struct Configuration {
+        std::string name;
+        MaphSAT::Heuristic heuristic;
+        MaphSAT::Options options;
+    };
+
+    // The measurements of one file with one configuration. The times are in seconds and are
+    // the medians over the repetitions, and the peak resident set size in kilobytes is the
+    // largest of them. The status is SATISFIABLE, UNSATISFIABLE, UNKNOWN if the solver ran
+    // out of time, WRONG if its model does not satisfy the formula, or ERROR.
+    struct Result {
+        std::string suite;
+        std::string file;
+        std::string configuration;
+        std::string status;
+        double parse;
+        double preprocess;
+        double propagate;
+        double analyze;
+        double decide;
+        double wall;
+        double cpu;
+        long peakMemory;
+    };
+
+private:
+
+    std::vector<std::string> suites;
+    std::vector<Configuration> configurations;
+    std::size_t warmups;
+    std::size_t repetitions;
+    double timeout;
+
+    std::vector<Result> results;
+
+    // Solve a file once in a child process.
+    Result run(const std::string & path, const Configuration & configuration) const;
+
+    // The CNF files of a suite in alphabetical order. Compressed files are included.
+    static std::vector<std::string> listFiles(const std::string & suite);
+
+public:
+
+    Benchmark(const std::vector<std::string> & suites, const std::vector<Configuration> & configurations,
+        std::size_t warmups, std::size_t repetitions, double timeout);
+
+    // Run every file of every suite with every configuration, printing one line per result.
+    void run(std::ostream & progress);
+
+    const std::vector<Result> & getResults() const { return results; }
+
+    void writeJson(std::ostream &) const;
+    void writeCsv(std::ostream &) const;
+
+    // Read results written by 'writeCsv'. Returns false if the input is malformed.
+    static bool readCsv(std::istream &, std::vector<Result> &);
+
+    // Compare the results with a baseline and print a line for each regression: a different
+    // answer, a file that is no longer solved, or a CPU time or peak memory more than
+    // 'threshold' (a fraction) above the baseline. Differences below 'minimumSeconds' and
+    // 'minimumKilobytes' are noise. Returns the number of regressions.
+    std::size_t compare(const std::vector<Result> & baseline, double threshold, double minimumSeconds,
+        long minimumKilobytes, std::ostream & out) const;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "maphBench.hpp"
+
+// Differences in CPU time and peak memory below these are treated as noise when comparing
+// with a baseline.
+static constexpr double minimumSeconds = 0.05;
+static constexpr long minimumKilobytes = 1024;
+
+void printError(char * prog) {
+    std::cerr << "Usage: " << prog << " [options] <directory of CNF files>...\n\n"
+    << "Solves every CNF file of the directories with every combination of heuristic and options.\n\n"
+    << "Options:\n"
+    << "  --heuristic <0-10>       add a selection heuristic to the matrix (default: 10)\n"
+    << "  --options \"<options>\"    add a set of solver options to the matrix, such as\n"
+    << "                           \"--restarts glucose --phase-saving\" (default: none)\n"
+    << "  --warmups <n>            unmeasured runs before the measured ones (default: 1)\n"
+    << "  --repetitions <n>        measured runs, of which the median is reported (default: 3)\n"
+    << "  --timeout <seconds>      interrupt the search and report UNKNOWN after this time (default: 60)\n"
+    << "  --json <file>            write the results as JSON\n"
+    << "  --csv <file>             write the results as CSV\n"
+    << "  --baseline <file>        compare with the CSV results of an earlier run and report regressions\n"
+    << "  --threshold <fraction>   the growth of CPU time or peak memory that is a regression (default: 0.1)\n";
+}
+
+// Parse the solver options of a configuration, which are separated by white space.
+bool parseConfiguration(int heuristic, const std::string & text, Benchmark::Configuration & configuration) {
+    std::istringstream stream(text);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word)
+        words.push_back(word);
+    std::vector<const char *> arguments;
+    for (const std::string & argument : words)
+        arguments.push_back(argument.c_str());
+
+    configuration.name = std::to_string(heuristic);
+    configuration.heuristic = static_cast<MaphSAT::Heuristic>(heuristic);
+    configuration.options = MaphSAT::Options();
+    for (int i = 0; i < static_cast<int>(arguments.size()); ++i) {
+        if (!configuration.options.parse(arguments.data(), arguments.size(), i))
+            return false;
+    }
+    for (const std::string & argument : words)
+        configuration.name += ' ' + argument;
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    std::vector<int> heuristics;
+    std::vector<std::string> optionSets;
+    std::vector<std::string> suites;
+    std::size_t warmups = 1;
+    std::size_t repetitions = 3;
+    double timeout = 60;
+    const char * jsonPath = nullptr;
+    const char * csvPath = nullptr;
+    const char * baselinePath = nullptr;
+    double threshold = 0.1;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--heuristic") == 0 && hasValue) {
+            heuristics.push_back(atoi(argv[++i]));
+            if (heuristics.back() < 0 || heuristics.back() > 10) {
+                printError(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--options") == 0 && hasValue)
+            optionSets.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--warmups") == 0 && hasValue)
+            warmups = atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue && atoi(argv[i + 1]) > 0)
+            repetitions = atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--timeout") == 0 && hasValue && atof(argv[i + 1]) > 0)
+            timeout = atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+            jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--csv") == 0 && hasValue)
+            csvPath = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue)
+            baselinePath = argv[++i];
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue && atof(argv[i + 1]) >= 0)
+            threshold = atof(argv[++i]);
+        else if (argv[i][0] != '-')
+            suites.push_back(argv[i]);
+        else {
+            printError(argv[0]);
+            return 1;
+        }
+    }
+    if (suites.empty()) {
+        printError(argv[0]);
+        return 1;
+    }
+    if (heuristics.empty())
+        heuristics.push_back(static_cast<int>(MaphSAT::Heuristic::VSIDS));
+    if (optionSets.empty())
+        optionSets.push_back("");
+
+    std::vector<Benchmark::Configuration> configurations;
+    for (int heuristic : heuristics) {
+        for (const std::string & optionSet : optionSets) {
+            configurations.emplace_back();
+            if (!parseConfiguration(heuristic, optionSet, configurations.back())) {
+                std::cerr << "Invalid solver options: " << optionSet << "\n";
+                return 1;
+            }
+        }
+    }
+
+    // Read the baseline first, so that a missing one is reported before the runs.
+    std::vector<Benchmark::Result> baseline;
+    if (baselinePath != nullptr) {
+        std::ifstream in(baselinePath);
+        if (!in || !Benchmark::readCsv(in, baseline)) {
+            std::cerr << "Cannot read the baseline " << baselinePath << ".\n";
+            return 1;
+        }
+    }
+
+    Benchmark benchmark(suites, configurations, warmups, repetitions, timeout);
+    benchmark.run(std::cout);
+
+    if (jsonPath != nullptr) {
+        std::ofstream out(jsonPath);
+        benchmark.writeJson(out);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << ".\n";
+            return 1;
+        }
+    }
+    if (csvPath != nullptr) {
+        std::ofstream out(csvPath);
+        benchmark.writeCsv(out);
+        if (!out) {
+            std::cerr << "Cannot write " << csvPath << ".\n";
+            return 1;
+        }
+    }
+
+    // Regressions make the exit status 2, so that scripts can stop on them.
+    if (baselinePath != nullptr) {
+        const std::size_t regressions = benchmark.compare(baseline, threshold, minimumSeconds, minimumKilobytes, std::cout);
+        std::cout << regressions << " regression" << (regressions == 1 ? "" : "s") << " compared with " << baselinePath << "\n";
+        if (regressions > 0)
+            return 2;
+    }
+}
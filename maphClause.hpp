@@ -0,0 +1,165 @@
+#ifndef __MAPHCLAUSE_HPP__
+#define __MAPHCLAUSE_HPP__
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Literals are encoded as 2 * variable + sign, where the sign bit is set for negative
+// literals. Variables are numbered from 1, so the literal 0 never occurs in a clause
+// and is used to denote the absence of a literal.
+using Literal = std::uint32_t;
+
+constexpr Literal noLiteral = 0;
+
+// The literal of 'variable' with the given polarity.
+inline Literal makeLiteral(std::uint32_t variable, bool negative) {
+    return 2u * variable + (negative ? 1u : 0u);
+}
+
+// Convert a DIMACS literal to its encoding.
+inline Literal toLiteral(int literal) {
+    return literal > 0 ? 2u * literal : 2u * -literal + 1;
+}
+
+// Convert an encoded literal back to a DIMACS literal.
+inline int toDimacs(Literal literal) {
+    const int variable = literal >> 1;
+    return (literal & 1) ? -variable : variable;
+}
+
+inline Literal negate(Literal literal) {
+    return literal ^ 1;
+}
+
+inline std::uint32_t variableOf(Literal literal) {
+    return literal >> 1;
+}
+
+inline bool isNegative(Literal literal) {
+    return literal & 1;
+}
+
+// A clause is referenced by its offset in the clause arena.
+using ClauseRef = std::uint32_t;
+
+constexpr ClauseRef noClause = std::numeric_limits<ClauseRef>::max();
+
+// An entry of a watch list. The blocker is another literal of the clause; if it is true,
+// the clause is satisfied and does not need to be visited. For binary clauses the
+// blocker is the other literal, so they propagate without visiting the clause at all.
+struct Watch {
+    ClauseRef clause;
+    Literal blocker;
+};
+
+// A view of a clause stored in the arena. The header consists of three words: the number
+// of literals, the flags together with the LBD, and the activity of a learned clause. The
+// literals follow the header.
+template <typename Word>
+class ClauseView {
+
+    Word * data;
+
+    static constexpr std::uint32_t learnedFlag = 1u;
+    static constexpr std::uint32_t deletedFlag = 2u;
+    static constexpr std::uint32_t usedFlag = 4u;
+    static constexpr std::uint32_t vivifiedFlag = 8u;
+    static constexpr std::uint32_t flagBits = 4;
+
+public:
+
+    static constexpr std::size_t headerSize = 3;
+
+    explicit ClauseView(Word * data) : data(data) {}
+
+    std::uint32_t size() const { return data[0]; }
+
+    // Drop the literals from position 'size' on. Their words stay in the arena until the
+    // next garbage collection.
+    void shrink(std::uint32_t size) const { data[0] = size; }
+
+    bool learned() const { return data[1] & learnedFlag; }
+
+    // A deleted clause is dropped by the next garbage collection.
+    bool deleted() const { return data[1] & deletedFlag; }
+    void markDeleted() const { data[1] |= deletedFlag; }
+
+    // Has the clause taken part in conflict analysis since the last database reduction?
+    bool used() const { return data[1] & usedFlag; }
+    void setUsed(bool used) const { data[1] = used ? data[1] | usedFlag : data[1] & ~usedFlag; }
+
+    // Has the clause been vivified by inprocessing?
+    bool vivified() const { return data[1] & vivifiedFlag; }
+    void setVivified() const { data[1] |= vivifiedFlag; }
+
+    // The literal block distance of a learned clause when it was learned or last used.
+    std::uint32_t lbd() const { return data[1] >> flagBits; }
+    void setLBD(std::uint32_t lbd) const { data[1] = (data[1] & ((1u << flagBits) - 1)) | (lbd << flagBits); }
+
+    float activity() const {
+        float activity;
+        std::memcpy(&activity, &data[2], sizeof(activity));
+        return activity;
+    }
+    void setActivity(float activity) const { std::memcpy(&data[2], &activity, sizeof(activity)); }
+
+    Word & operator[](std::size_t index) const { return data[headerSize + index]; }
+
+    Word * begin() const { return data + headerSize; }
+
+    Word * end() const { return data + headerSize + data[0]; }
+};
+
+using Clause = ClauseView<Literal>;
+using ConstClause = ClauseView<const Literal>;
+
+// Stores all clauses contiguously in a single block of memory.
+class ClauseArena {
+
+    std::vector<std::uint32_t> memory;
+
+public:
+
+    void reserve(std::size_t words) { memory.reserve(words); }
+
+    // Remove all clauses, keeping the memory for new ones.
+    void clear() { memory.clear(); }
+
+    // The number of words in use.
+    std::size_t size() const { return memory.size(); }
+
+    // Copy the literals in [first, last) into the arena and return a reference to the new clause.
+    // Allocating may move the arena, which invalidates any clause views.
+    template <typename Iterator>
+    ClauseRef allocate(Iterator first, Iterator last, bool learned) {
+        const ClauseRef ref = memory.size();
+        memory.push_back(0);
+        memory.push_back(learned ? 1u : 0u);
+        memory.push_back(0);
+        memory.insert(memory.end(), first, last);
+        memory[ref] = memory.size() - ref - Clause::headerSize;
+        return ref;
+    }
+
+    // Copy clause 'ref' into 'to' and return the reference of the copy. The activity
+    // word of the original is overwritten with that reference (see 'forward').
+    ClauseRef relocate(ClauseRef ref, ClauseArena & to) {
+        const ClauseRef copy = to.memory.size();
+        const auto first = memory.begin() + ref;
+        to.memory.insert(to.memory.end(), first, first + Clause::headerSize + memory[ref]);
+        memory[ref + 2] = copy;
+        return copy;
+    }
+
+    // The reference of the copy of a relocated clause.
+    ClauseRef forward(ClauseRef ref) const { return memory[ref + 2]; }
+
+    Clause operator[](ClauseRef ref) { return Clause(memory.data() + ref); }
+
+    ConstClause operator[](ClauseRef ref) const { return ConstClause(memory.data() + ref); }
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include <thread>
+
+#include "maphCube.hpp"
+
+constexpr std::size_t CubeAndConquer::cubesPerThread;
+constexpr std::size_t CubeAndConquer::initialDepth;
+constexpr std::size_t CubeAndConquer::cubeConflicts;
+
+// Variable elimination would remove variables that cubes refer to, so the solvers do not
+// preprocess. Variables substituted by inprocessing are mapped to their representatives.
+CubeAndConquer::CubeAndConquer(const Formula & formula, std::size_t numberThreads, MaphSAT::Heuristic heuristic,
+    const MaphSAT::Options & options) :
+    formula(formula), numberThreads(numberThreads), heuristic(heuristic), options(options),
+    solvers(numberThreads), openCubes(0), winner(-1), stopped(false) {
+    this->options.preprocess = false;
+    for (std::size_t thread = 0; thread < numberThreads; ++thread) {
+        buffers.emplace_back(new ClauseBuffer());
+        queues.emplace_back(new WorkQueue());
+    }
+}
+
+// Split the formula breadth-first with a cuber that maintains the occurrence counters, so
+// that lookahead can rate the variables with the Jeroslow-Wang weights.
+bool CubeAndConquer::split() {
+    MaphSAT::Options cuberOptions;
+    cuberOptions.reduceDatabase = false;
+    MaphSAT cuber(formula, MaphSAT::Heuristic::JW, cuberOptions);
+
+    std::deque<std::vector<Literal> > cubes(1);
+    std::vector<std::vector<Literal> > leaves;
+    while (!cubes.empty() && cubes.size() + leaves.size() < cubesPerThread * numberThreads) {
+        std::vector<Literal> cube = std::move(cubes.front());
+        cubes.pop_front();
+        Literal literal;
+        if (!cuber.lookahead(cube, literal))
+            continue;
+        if (literal == noLiteral || cube.size() >= initialDepth) {
+            leaves.push_back(std::move(cube));
+            continue;
+        }
+        cubes.push_back(cube);
+        cubes.back().push_back(literal);
+        cube.push_back(negate(literal));
+        cubes.push_back(std::move(cube));
+    }
+    leaves.insert(leaves.end(), cubes.begin(), cubes.end());
+
+    openCubes = leaves.size();
+    for (std::size_t i = 0; i < leaves.size(); ++i)
+        queues[i % numberThreads]->cubes.push_back({std::move(leaves[i]), cubeConflicts});
+    return !leaves.empty();
+}
+
+bool CubeAndConquer::take(std::size_t thread, Cube & cube) {
+    {
+        WorkQueue & own = *queues[thread];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.cubes.empty()) {
+            cube = std::move(own.cubes.back());
+            own.cubes.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < numberThreads; ++i) {
+        WorkQueue & victim = *queues[(thread + i) % numberThreads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.cubes.empty()) {
+            cube = std::move(victim.cubes.front());
+            victim.cubes.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void CubeAndConquer::push(std::size_t thread, Cube cube) {
+    WorkQueue & own = *queues[thread];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    own.cubes.push_back(std::move(cube));
+}
+
+bool CubeAndConquer::finished() const {
+    return winner.load() != -1 || openCubes.load() == 0 || stopped.load();
+}
+
+// The mutex is taken so that the wakeup cannot fall between the test and the wait of a thread.
+void CubeAndConquer::wakeIdle() {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    cubeQueued.notify_all();
+}
+
+void CubeAndConquer::run(std::size_t thread) {
+    std::unique_ptr<MaphSAT> solver(new MaphSAT(formula, heuristic, options));
+    std::vector<const ClauseBuffer *> imports;
+    for (std::size_t other = 0; other < numberThreads; ++other) {
+        if (other != thread)
+            imports.push_back(buffers[other].get());
+    }
+    solver->shareClauses(buffers[thread].get(), imports);
+
+    MaphSAT * running = solver.get();
+    {
+        std::lock_guard<std::mutex> lock(solversMutex);
+        solvers[thread] = std::move(solver);
+        if (winner.load() != -1 || stopped.load())
+            running->interrupt();
+    }
+
+    Cube cube;
+    while (!finished()) {
+        if (!take(thread, cube)) {
+            bool taken = false;
+            std::unique_lock<std::mutex> lock(idleMutex);
+            cubeQueued.wait(lock, [&] { return finished() || (taken = take(thread, cube)); });
+            if (!taken)
+                return;
+        }
+
+        if (running->solve(cube.literals, cube.budget)) {
+            int none = -1;
+            if (winner.compare_exchange_strong(none, static_cast<int>(thread))) {
+                std::lock_guard<std::mutex> lock(solversMutex);
+                for (const auto & other : solvers) {
+                    if (other && other.get() != running)
+                        other->interrupt();
+                }
+            }
+            wakeIdle();
+            return;
+        }
+        if (winner.load() != -1)
+            return;
+        if (running->limitReached() != MaphSAT::Limit::NONE) {
+            stopped.store(true);
+            {
+                std::lock_guard<std::mutex> lock(solversMutex);
+                for (const auto & other : solvers) {
+                    if (other && other.get() != running)
+                        other->interrupt();
+                }
+            }
+            wakeIdle();
+            return;
+        }
+
+        // A cube that is neither satisfiable nor refuted ran out of budget and is split.
+        Literal literal = noLiteral;
+        if (!running->isSolved() && running->lookahead(cube.literals, literal)) {
+            const std::size_t budget = literal == noLiteral ? MaphSAT::noBudget : 2 * cube.budget;
+            if (literal != noLiteral) {
+                Cube other{cube.literals, budget};
+                other.literals.push_back(negate(literal));
+                ++openCubes;
+                push(thread, std::move(other));
+                cube.literals.push_back(literal);
+                wakeIdle();
+            }
+            push(thread, {std::move(cube.literals), budget});
+            continue;
+        }
+        if (--openCubes == 0)
+            wakeIdle();
+    }
+}
+
+// Solve the formula using all threads.
+bool CubeAndConquer::solve() {
+    if (!split())
+        return false;
+
+    std::vector<std::thread> threads;
+    for (std::size_t thread = 0; thread < numberThreads; ++thread)
+        threads.emplace_back(&CubeAndConquer::run, this, thread);
+    for (std::thread & thread : threads)
+        thread.join();
+
+    return winner.load() != -1;
+}
+
+std::ostream & operator<<(std::ostream & out, const CubeAndConquer & cubes) {
+    const int winner = cubes.winner.load();
+    if (winner != -1)
+        return out << *cubes.solvers[winner];
+    return out << (cubes.openCubes.load() == 0 ? "s UNSATISFIABLE\n" : "s UNKNOWN\n");
+}
@@ -0,0 +1,108 @@
+#ifndef __MAPHCUBE_HPP__
+#define __MAPHCUBE_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "maphClause.hpp"
+#include "maphDimacs.hpp"
+#include "maphSat.hpp"
+#include "maphShare.hpp"
+
+// Solves a formula by cube-and-conquer: a lookahead cuber splits the formula into cubes,
+// conjunctions of literals that together cover every assignment, and a pool of threads
+// solves the cubes as assumptions. A cube that is not solved within its conflict budget is
+// split again by lookahead. Each thread takes cubes from its own queue and steals from the
+// others when it runs out, and sleeps while every queue is empty. The formula is satisfiable if any cube is, and unsatisfiable
+// once every cube has been refuted.
+class CubeAndConquer {
+
+    // A cube and the number of conflicts its search may take before it is split.
+    struct Cube {
+        std::vector<Literal> literals;
+        std::size_t budget;
+    };
+
+    // The cubes waiting in the queue of a thread. The owner works on the back of the queue
+    // and thieves take from the front, which holds the shallower and larger cubes.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Cube> cubes;
+    };
+
+    const Formula & formula;
+    std::size_t numberThreads;
+    MaphSAT::Heuristic heuristic;
+    MaphSAT::Options options;
+
+    // The solvers and the buffers of the clauses they export, indexed by thread. A solver
+    // is set up by its own thread, so it is null until its setup has finished.
+    std::vector<std::unique_ptr<MaphSAT> > solvers;
+    std::vector<std::unique_ptr<ClauseBuffer> > buffers;
+    std::vector<std::unique_ptr<WorkQueue> > queues;
+
+    // Guards 'solvers' so that a solver that is set up after a model has been found is
+    // stopped as well.
+    std::mutex solversMutex;
+
+    // The number of cubes that are queued or being solved. The formula is unsatisfiable
+    // once it drops to 0.
+    std::atomic<std::size_t> openCubes;
+
+    // The index of the thread that found a model, or -1.
+    std::atomic<int> winner;
+
+    // Set once a solver has been interrupted or has run out of a limit of the options, which
+    // stops every thread without an answer.
+    std::atomic<bool> stopped;
+
+    // Idle threads wait on 'cubeQueued' until a cube is split or the search is over.
+    std::mutex idleMutex;
+    std::condition_variable cubeQueued;
+
+    // The initial cubes are split until there are 'cubesPerThread' per thread, or until
+    // they fix 'initialDepth' variables.
+    static constexpr std::size_t cubesPerThread = 16;
+    static constexpr std::size_t initialDepth = 16;
+
+    // The conflict budget of the initial cubes. Each split doubles it, so that a cube that
+    // keeps proving hard is eventually solved without splitting.
+    static constexpr std::size_t cubeConflicts = 1000;
+
+    // Split the formula into the initial cubes and deal them out to the queues. Returns
+    // false if every cube has been refuted already.
+    bool split();
+
+    // Take a cube from the queue of 'thread', or steal one from another queue.
+    bool take(std::size_t thread, Cube & cube);
+
+    void push(std::size_t thread, Cube cube);
+
+    // Whether a model has been found, every cube has been refuted, or the threads were stopped.
+    bool finished() const;
+
+    // Wake the idle threads to take a new cube or to return.
+    void wakeIdle();
+
+    // Set up the solver of a thread and solve cubes until the answer is known.
+    void run(std::size_t thread);
+
+public:
+
+    CubeAndConquer(const Formula & formula, std::size_t numberThreads, MaphSAT::Heuristic heuristic,
+        const MaphSAT::Options & options);
+
+    // Solve the formula using all threads.
+    bool solve();
+
+    // Print the answer, and the model found if the formula is satisfiable.
+    friend std::ostream & operator<<(std::ostream &, const CubeAndConquer &);
+};
+
+#endif
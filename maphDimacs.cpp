@@ -0,0 +1,418 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "maphDimacs.hpp"
+
+// The size of the chunks in which files are read and decompressed.
+static constexpr std::size_t chunkSize = 1 << 20;
+
+// Produces the text of a file that cannot be mapped into memory, in chunks. The
+// decompressor owns the file descriptor of the file.
+class Decompressor {
+
+    int file;
+
+    // The first chunk of the file, which has been read to look at its magic bytes.
+    std::size_t pending;
+
+protected:
+
+    // The last chunk read from the file.
+    std::vector<char> input;
+
+    // Read the next chunk of the file into 'input' and return its size, which is 0 at the end of the file.
+    std::size_t fill() {
+        if (pending > 0) {
+            const std::size_t size = pending;
+            pending = 0;
+            return size;
+        }
+        ssize_t size;
+        do {
+            size = ::read(file, input.data(), input.size());
+        } while (size < 0 && errno == EINTR);
+        if (size < 0)
+            throw std::invalid_argument("Error reading DIMACS.");
+        return size;
+    }
+
+public:
+
+    Decompressor(int file, std::vector<char> && first, std::size_t size) :
+        file(file), pending(size), input(std::move(first)) {}
+
+    virtual ~Decompressor() { close(file); }
+
+    // Write the next at most 'size' bytes of text into 'out' and return their number,
+    // which is 0 only at the end of the text.
+    virtual std::size_t read(char * out, std::size_t size) = 0;
+};
+
+namespace {
+
+// Reads a file that is not compressed but cannot be mapped, such as a pipe.
+class PlainReader : public Decompressor {
+
+    std::size_t offset;
+    std::size_t available;
+
+public:
+
+    PlainReader(int file, std::vector<char> && first, std::size_t size) :
+        Decompressor(file, std::move(first), size), offset(0), available(0) {}
+
+    std::size_t read(char * out, std::size_t size) override {
+        if (available == 0) {
+            available = fill();
+            offset = 0;
+        }
+        size = std::min(size, available);
+        std::memcpy(out, input.data() + offset, size);
+        offset += size;
+        available -= size;
+        return size;
+    }
+};
+
+// Decompresses gzip files, which may consist of several concatenated members.
+class GzipDecompressor : public Decompressor {
+
+    z_stream stream;
+
+    // Has the last member ended without any input following it?
+    bool finished;
+
+public:
+
+    GzipDecompressor(int file, std::vector<char> && first, std::size_t size) :
+        Decompressor(file, std::move(first), size), stream(), finished(false) {
+        if (inflateInit2(&stream, 15 + 16) != Z_OK)
+            throw std::runtime_error("Error initializing zlib.");
+    }
+
+    ~GzipDecompressor() override { inflateEnd(&stream); }
+
+    std::size_t read(char * out, std::size_t size) override {
+        stream.next_out = reinterpret_cast<Bytef *>(out);
+        stream.avail_out = size;
+        while (stream.avail_out == size) {
+            if (stream.avail_in == 0) {
+                stream.next_in = reinterpret_cast<Bytef *>(input.data());
+                stream.avail_in = fill();
+                if (stream.avail_in == 0) {
+                    if (!finished)
+                        throw std::invalid_argument("Error decompressing DIMACS: unexpected end of gzip data.");
+                    break;
+                }
+            }
+            finished = false;
+            const int result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                finished = true;
+                inflateReset(&stream);
+            } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                throw std::invalid_argument("Error decompressing DIMACS: invalid gzip data.");
+            }
+        }
+        return size - stream.avail_out;
+    }
+};
+
+// Decompresses xz files, which may consist of several concatenated streams.
+class XzDecompressor : public Decompressor {
+
+    lzma_stream stream;
+    bool endOfFile;
+
+public:
+
+    XzDecompressor(int file, std::vector<char> && first, std::size_t size) :
+        Decompressor(file, std::move(first), size), stream(LZMA_STREAM_INIT), endOfFile(false) {
+        if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+            throw std::runtime_error("Error initializing liblzma.");
+    }
+
+    ~XzDecompressor() override { lzma_end(&stream); }
+
+    std::size_t read(char * out, std::size_t size) override {
+        stream.next_out = reinterpret_cast<std::uint8_t *>(out);
+        stream.avail_out = size;
+        while (stream.avail_out == size) {
+            if (stream.avail_in == 0 && !endOfFile) {
+                stream.next_in = reinterpret_cast<std::uint8_t *>(input.data());
+                stream.avail_in = fill();
+                endOfFile = stream.avail_in == 0;
+            }
+            const lzma_ret result = lzma_code(&stream, endOfFile ? LZMA_FINISH : LZMA_RUN);
+            if (result == LZMA_STREAM_END)
+                break;
+            if (result != LZMA_OK)
+                throw std::invalid_argument("Error decompressing DIMACS: invalid xz data.");
+        }
+        return size - stream.avail_out;
+    }
+};
+
+// Decompresses bzip2 files, which may consist of several concatenated streams.
+class Bzip2Decompressor : public Decompressor {
+
+    bz_stream stream;
+
+    // Has the last stream ended without any input following it?
+    bool finished;
+
+public:
+
+    Bzip2Decompressor(int file, std::vector<char> && first, std::size_t size) :
+        Decompressor(file, std::move(first), size), stream(), finished(false) {
+        if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK)
+            throw std::runtime_error("Error initializing libbz2.");
+    }
+
+    ~Bzip2Decompressor() override { BZ2_bzDecompressEnd(&stream); }
+
+    std::size_t read(char * out, std::size_t size) override {
+        stream.next_out = out;
+        stream.avail_out = size;
+        while (stream.avail_out == size) {
+            if (stream.avail_in == 0) {
+                stream.next_in = input.data();
+                stream.avail_in = fill();
+                if (stream.avail_in == 0) {
+                    if (!finished)
+                        throw std::invalid_argument("Error decompressing DIMACS: unexpected end of bzip2 data.");
+                    break;
+                }
+            }
+            if (finished) {
+                // Another stream follows the last one.
+                BZ2_bzDecompressEnd(&stream);
+                const bz_stream previous = stream;
+                if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK)
+                    throw std::runtime_error("Error initializing libbz2.");
+                stream.next_in = previous.next_in;
+                stream.avail_in = previous.avail_in;
+                stream.next_out = previous.next_out;
+                stream.avail_out = previous.avail_out;
+                finished = false;
+            }
+            const int result = BZ2_bzDecompress(&stream);
+            if (result == BZ_STREAM_END)
+                finished = true;
+            else if (result != BZ_OK)
+                throw std::invalid_argument("Error decompressing DIMACS: invalid bzip2 data.");
+        }
+        return size - stream.avail_out;
+    }
+};
+
+}
+
+// Does the text start with the given magic bytes?
+static bool hasMagic(const char * text, std::size_t size, const char * magic, std::size_t magicSize) {
+    return size >= magicSize && std::memcmp(text, magic, magicSize) == 0;
+}
+
+DimacsParser::DimacsParser(const char * path) :
+    data(nullptr), length(0), open(false), position(nullptr), end(nullptr), textSize(0), numberVariables(0),
+    numberClauses(0), clausesRead(0), currentStamp(0) {
+    const int file = ::open(path, O_RDONLY);
+    if (file < 0)
+        return;
+
+    // Map plain regular files into memory.
+    struct stat status;
+    char magic[6];
+    if (fstat(file, &status) == 0 && S_ISREG(status.st_mode) &&
+        (status.st_size < 6 || pread(file, magic, 6, 0) != 6 ||
+         !(hasMagic(magic, 6, "\x1f\x8b", 2) || hasMagic(magic, 6, "\xfd" "7zXZ\0", 6) || hasMagic(magic, 6, "BZh", 3)))) {
+        length = status.st_size;
+        if (length == 0) {
+            open = true;
+        } else {
+            void * mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping != MAP_FAILED) {
+                data = static_cast<char *>(mapping);
+                open = true;
+                // The file is scanned once from start to end.
+                madvise(data, length, MADV_SEQUENTIAL);
+            } else {
+                length = 0;
+            }
+        }
+        close(file);
+        position = data;
+        end = data + length;
+        textSize = length;
+        return;
+    }
+
+    // Read the first chunk of any other file and pick a decompressor by its magic bytes.
+    std::vector<char> first(chunkSize);
+    ssize_t size;
+    do {
+        size = ::read(file, first.data(), first.size());
+    } while (size < 0 && errno == EINTR);
+    if (size < 0) {
+        close(file);
+        return;
+    }
+    if (hasMagic(first.data(), size, "\x1f\x8b", 2))
+        decompressor.reset(new GzipDecompressor(file, std::move(first), size));
+    else if (hasMagic(first.data(), size, "\xfd" "7zXZ\0", 6))
+        decompressor.reset(new XzDecompressor(file, std::move(first), size));
+    else if (hasMagic(first.data(), size, "BZh", 3))
+        decompressor.reset(new Bzip2Decompressor(file, std::move(first), size));
+    else
+        decompressor.reset(new PlainReader(file, std::move(first), size));
+    open = true;
+    buffer.resize(chunkSize);
+}
+
+DimacsParser::DimacsParser(const char * text, std::size_t size) :
+    data(nullptr), length(0), open(true), position(text), end(text + size), textSize(size), numberVariables(0),
+    numberClauses(0), clausesRead(0), currentStamp(0) {}
+
+DimacsParser::~DimacsParser() {
+    if (data != nullptr)
+        munmap(data, length);
+}
+
+// Decompress the next chunk of text into the buffer. Returns false at the end of the text.
+bool DimacsParser::refill() {
+    if (!decompressor)
+        return false;
+    const std::size_t size = decompressor->read(buffer.data(), buffer.size());
+    textSize += size;
+    position = buffer.data();
+    end = position + size;
+    return size > 0;
+}
+
+// Skip whitespace and comment lines.
+void DimacsParser::skipBlanks() {
+    while (more()) {
+        const char c = *position;
+        if (c == 'c') {
+            while (more() && *position != '\n')
+                ++position;
+        } else if (c == ' ' || c == '\n' || c == '\t' || c == '\r') {
+            ++position;
+        } else {
+            return;
+        }
+    }
+}
+
+// Scan an unsigned integer. Values that do not fit into a literal are rejected.
+std::size_t DimacsParser::scanUnsigned() {
+    if (!more() || *position < '0' || *position > '9')
+        throw std::invalid_argument("Error parsing DIMACS.");
+    std::size_t value = 0;
+    while (more() && *position >= '0' && *position <= '9') {
+        value = 10 * value + (*position++ - '0');
+        if (value > std::numeric_limits<std::int32_t>::max())
+            throw std::invalid_argument("Error parsing DIMACS.");
+    }
+    return value;
+}
+
+// Parse the 'p cnf' header and return the number of variables and clauses it declares.
+void DimacsParser::readHeader(std::size_t & variables, std::size_t & clauses) {
+    skipBlanks();
+    for (const char * expected = "p cnf"; *expected != '\0'; ++expected, ++position) {
+        if (!more() || *position != *expected)
+            throw std::invalid_argument("Error parsing DIMACS.");
+    }
+
+    skipBlanks();
+    numberVariables = scanUnsigned();
+    skipBlanks();
+    numberClauses = scanUnsigned();
+
+    literalStamps.assign(2 * numberVariables + 2, 0);
+    variables = numberVariables;
+    clauses = numberClauses;
+}
+
+// Parse the next clause into 'clause' without duplicate literals, skipping tautologies.
+// Returns false once all clauses declared in the header have been read.
+bool DimacsParser::readClause(std::vector<Literal> & clause) {
+    while (clausesRead < numberClauses) {
+        ++clausesRead;
+        clause.clear();
+        bool tautology = false;
+        while (true) {
+            skipBlanks();
+            const bool negative = more() && *position == '-';
+            if (negative)
+                ++position;
+            const std::size_t variable = scanUnsigned();
+            if (variable == 0)
+                break;
+            if (variable > numberVariables)
+                throw std::invalid_argument("Error parsing DIMACS.");
+            clause.push_back(makeLiteral(variable, negative));
+        }
+        if (clause.size() <= shortClause) {
+            // Short clauses are checked pairwise, which avoids touching the stamps of
+            // variables spread over the whole formula.
+            auto keep = clause.begin();
+            for (auto it = clause.begin(); it != clause.end(); ++it) {
+                bool duplicate = false;
+                for (auto other = clause.begin(); other != keep; ++other) {
+                    duplicate |= *other == *it;
+                    tautology |= *other == negate(*it);
+                }
+                if (!duplicate)
+                    *keep++ = *it;
+            }
+            clause.erase(keep, clause.end());
+        } else {
+            ++currentStamp;
+            auto keep = clause.begin();
+            for (auto it = clause.begin(); it != clause.end(); ++it) {
+                if (literalStamps[negate(*it)] == currentStamp)
+                    tautology = true;
+                else if (literalStamps[*it] != currentStamp) {
+                    literalStamps[*it] = currentStamp;
+                    *keep++ = *it;
+                }
+            }
+            clause.erase(keep, clause.end());
+        }
+        if (!tautology)
+            return true;
+    }
+    return false;
+}
+
+// Parse the whole file into 'formula'.
+void DimacsParser::read(Formula & formula) {
+    readHeader(formula.numberVariables, formula.numberClauses);
+    formula.clauses.reserve(formula.numberClauses);
+    formula.arena.reserve(formula.numberClauses * (Clause::headerSize + 3));
+
+    std::vector<Literal> clause;
+    while (readClause(clause)) {
+        if (clause.empty())
+            formula.hasEmptyClause = true;
+        else if (clause.size() == 1)
+            formula.units.push_back(clause[0]);
+        else
+            formula.clauses.push_back(formula.arena.allocate(clause.begin(), clause.end(), false));
+    }
+}
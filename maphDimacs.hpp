@@ -0,0 +1,102 @@
+#ifndef __MAPHDIMACS_HPP__
+#define __MAPHDIMACS_HPP__
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "maphClause.hpp"
+
+// Produces the text of a file that cannot be mapped into memory, in chunks.
+class Decompressor;
+
+// A CNF formula as read from a DIMACS file, from which any number of solvers can be set up.
+// Clauses with at least two literals are kept in the arena and unit clauses apart.
+struct Formula {
+    std::size_t numberVariables;
+    std::size_t numberClauses;
+    ClauseArena arena;
+    std::vector<ClauseRef> clauses;
+    std::vector<Literal> units;
+    // Does the formula contain the empty clause?
+    bool hasEmptyClause;
+
+    Formula() : numberVariables(0), numberClauses(0), hasEmptyClause(false) {}
+};
+
+// Reads a CNF formula in DIMACS format from a file. Plain files are mapped into memory
+// and scanned in place, so no copy of their text is made. Files compressed with gzip, xz
+// or bzip2 are recognized by their magic bytes and decompressed in chunks into a buffer
+// that is reused, so their whole text is never held in memory.
+class DimacsParser {
+
+    // The mapped file and its size.
+    char * data;
+    std::size_t length;
+    bool open;
+
+    // The decompressor of a file that is not mapped and the buffer it decompresses into.
+    std::unique_ptr<Decompressor> decompressor;
+    std::vector<char> buffer;
+
+    // The next character to scan and the end of the text that is available.
+    const char * position;
+    const char * end;
+
+    // The number of bytes of text that have been made available to the scanner.
+    std::size_t textSize;
+
+    std::size_t numberVariables;
+    std::size_t numberClauses;
+    std::size_t clausesRead;
+
+    // Used to remove duplicate literals and tautologies from clauses longer than
+    // 'shortClause'. A literal occurs in the current clause if its stamp equals 'currentStamp'.
+    // Shorter clauses are checked pairwise.
+    std::vector<std::size_t> literalStamps;
+    std::size_t currentStamp;
+    static constexpr std::size_t shortClause = 8;
+
+    // Decompress the next chunk of text into the buffer. Returns false at the end of the text.
+    bool refill();
+
+    // Is there any text left to scan?
+    bool more() { return position != end || refill(); }
+
+    // Skip whitespace and comment lines.
+    void skipBlanks();
+
+    // Scan an unsigned integer.
+    std::size_t scanUnsigned();
+
+public:
+
+    explicit DimacsParser(const char * path);
+
+    // Scan DIMACS text held in memory, which has to outlive the parser.
+    DimacsParser(const char * text, std::size_t size);
+    ~DimacsParser();
+
+    DimacsParser(const DimacsParser &) = delete;
+    DimacsParser & operator=(const DimacsParser &) = delete;
+
+    // Has the file been opened successfully?
+    bool isOpen() const { return open; }
+
+    // The number of bytes of DIMACS text read so far. For a plain file this is its size.
+    std::size_t size() const { return textSize; }
+
+    // Parse the 'p cnf' header and return the number of variables and clauses it declares.
+    // Throws invalid_argument() if unsuccessful.
+    void readHeader(std::size_t & variables, std::size_t & clauses);
+
+    // Parse the next clause into 'clause' without duplicate literals. Tautologies are
+    // skipped. Returns false once all clauses declared in the header have been read.
+    // Throws invalid_argument() if unsuccessful.
+    bool readClause(std::vector<Literal> & clause);
+
+    // Parse the whole file into 'formula'. Throws invalid_argument() if unsuccessful.
+    void read(Formula & formula);
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <limits>
+
+#include "maphGauss.hpp"
+
+constexpr std::uint32_t GaussMatrix::noColumn;
+constexpr std::size_t GaussMatrix::maximumWords;
+
+// Each candidate clause is keyed by its sorted variables, so that the clauses over the same
+// variables are adjacent once the candidates are sorted. Bit i of 'signs' is set if the
+// literal of the i-th variable is negative.
+std::vector<XorConstraint> detectXors(const ClauseArena & arena, const std::vector<ClauseRef> & formula,
+    std::size_t maximumSize) {
+    struct Candidate {
+        std::size_t start;
+        std::uint32_t size;
+        std::uint32_t signs;
+    };
+    maximumSize = std::min<std::size_t>(maximumSize, 6);
+
+    std::vector<std::uint32_t> keys;
+    std::vector<Candidate> candidates;
+    std::vector<Literal> sorted;
+    for (ClauseRef ref : formula) {
+        const auto clause = arena[ref];
+        if (clause.learned() || clause.deleted() || clause.size() < 3 || clause.size() > maximumSize)
+            continue;
+        // Literals of the same variable are adjacent in the order of their encodings.
+        sorted.assign(clause.begin(), clause.end());
+        std::sort(sorted.begin(), sorted.end());
+        Candidate candidate{keys.size(), clause.size(), 0};
+        for (std::uint32_t i = 0; i < sorted.size(); ++i) {
+            keys.push_back(variableOf(sorted[i]));
+            if (isNegative(sorted[i]))
+                candidate.signs |= 1u << i;
+        }
+        candidates.push_back(candidate);
+    }
+
+    const auto sameVariables = [&keys](const Candidate & a, const Candidate & b) {
+        return a.size == b.size && std::equal(keys.begin() + a.start, keys.begin() + a.start + a.size, keys.begin() + b.start);
+    };
+    std::sort(candidates.begin(), candidates.end(), [&keys](const Candidate & a, const Candidate & b) {
+        if (a.size != b.size)
+            return a.size < b.size;
+        return std::lexicographical_compare(keys.begin() + a.start, keys.begin() + a.start + a.size,
+            keys.begin() + b.start, keys.begin() + b.start + b.size);
+    });
+
+    // A group of clauses over the same k variables encodes an XOR if it has all 2^(k-1) sign
+    // patterns of one parity. Each clause excludes the assignment that falsifies all of its
+    // literals, so an even number of negative literals excludes an even number of true
+    // variables, and the XOR has parity 1.
+    std::vector<XorConstraint> xors;
+    for (std::size_t first = 0; first < candidates.size();) {
+        std::size_t last = first;
+        std::uint64_t patterns = 0;
+        while (last < candidates.size() && sameVariables(candidates[first], candidates[last]))
+            patterns |= std::uint64_t(1) << candidates[last++].signs;
+
+        const std::uint32_t size = candidates[first].size;
+        std::size_t counts[2] = {0, 0};
+        for (std::uint32_t signs = 0; signs < (1u << size); ++signs) {
+            if ((patterns >> signs) & 1)
+                ++counts[__builtin_popcount(signs) & 1];
+        }
+        for (int negatives = 0; negatives < 2; ++negatives) {
+            if (counts[negatives] == (std::size_t(1) << (size - 1))) {
+                const auto start = keys.begin() + candidates[first].start;
+                xors.push_back({std::vector<std::uint32_t>(start, start + size), negatives == 0});
+            }
+        }
+        first = last;
+    }
+    return xors;
+}
+
+GaussMatrix::GaussMatrix(const std::vector<signed char> & values, const std::vector<std::size_t> & levels) :
+    values(values), levels(levels), numberWords(0) {}
+
+void GaussMatrix::clear() {
+    numberWords = 0;
+    bits.clear();
+    parities.clear();
+    columns.clear();
+    variables.clear();
+    basics.clear();
+    watches.clear();
+    watchers.clear();
+    implied.clear();
+    impliedColumns.clear();
+}
+
+bool GaussMatrix::build(std::size_t numberVariables, const std::vector<XorConstraint> & xors, std::vector<Literal> & units) {
+    clear();
+    columns.assign(numberVariables + 1, noColumn);
+    for (const XorConstraint & constraint : xors) {
+        for (std::uint32_t variable : constraint.variables) {
+            if (values[variable] == 0 && columns[variable] == noColumn) {
+                columns[variable] = variables.size();
+                variables.push_back(variable);
+            }
+        }
+    }
+    numberWords = (variables.size() + 63) / 64;
+    if (xors.size() * numberWords > maximumWords) {
+        clear();
+        return true;
+    }
+
+    // Variables assigned at level 0 are moved to the right-hand side.
+    std::size_t numberRows = xors.size();
+    bits.assign(numberRows * numberWords, 0);
+    parities.assign(numberRows, 0);
+    for (std::size_t index = 0; index < numberRows; ++index) {
+        parities[index] = xors[index].parity;
+        for (std::uint32_t variable : xors[index].variables) {
+            if (values[variable] != 0)
+                parities[index] ^= values[variable] > 0;
+            else
+                row(index)[columns[variable] >> 6] ^= std::uint64_t(1) << (columns[variable] & 63);
+        }
+    }
+
+    // Gauss-Jordan elimination. The rows from 'rank' on have no basic column yet.
+    std::size_t rank = 0;
+    for (std::uint32_t column = 0; column < variables.size() && rank < numberRows; ++column) {
+        std::size_t pivotRow = rank;
+        while (pivotRow < numberRows && !contains(pivotRow, column))
+            ++pivotRow;
+        if (pivotRow == numberRows)
+            continue;
+        std::swap_ranges(row(pivotRow), row(pivotRow) + numberWords, row(rank));
+        std::swap(parities[pivotRow], parities[rank]);
+        for (std::size_t index = 0; index < numberRows; ++index) {
+            if (index != rank && contains(index, column)) {
+                for (std::size_t word = 0; word < numberWords; ++word)
+                    row(index)[word] ^= row(rank)[word];
+                parities[index] ^= parities[rank];
+            }
+        }
+        basics.push_back(column);
+        ++rank;
+    }
+
+    // The remaining rows are empty. They are contradictions if their parity is 1.
+    for (std::size_t index = rank; index < numberRows; ++index) {
+        if (parities[index]) {
+            clear();
+            return false;
+        }
+    }
+
+    // A row with only its basic column fixes the value of its variable.
+    numberRows = 0;
+    for (std::size_t index = 0; index < rank; ++index) {
+        const std::uint32_t basic = basics[index];
+        row(index)[basic >> 6] ^= std::uint64_t(1) << (basic & 63);
+        const bool unit = std::all_of(row(index), row(index) + numberWords, [](std::uint64_t word) { return word == 0; });
+        row(index)[basic >> 6] ^= std::uint64_t(1) << (basic & 63);
+        if (unit) {
+            units.push_back(makeLiteral(variables[basic], !parities[index]));
+            continue;
+        }
+        std::copy(row(index), row(index) + numberWords, row(numberRows));
+        parities[numberRows] = parities[index];
+        basics[numberRows++] = basic;
+    }
+    bits.resize(numberRows * numberWords);
+    parities.resize(numberRows);
+    basics.resize(numberRows);
+
+    implied.assign(variables.size(), 0);
+    watchers.resize(variables.size());
+    watches.assign(numberRows, noColumn);
+    for (std::size_t index = 0; index < numberRows; ++index) {
+        watchers[basics[index]].push_back(index);
+        watch(index, findUnassigned(index, noColumn));
+    }
+    return true;
+}
+
+std::uint32_t GaussMatrix::findUnassigned(std::size_t index, std::uint32_t other) const {
+    const std::uint64_t * words = bits.data() + index * numberWords;
+    for (std::size_t word = 0; word < numberWords; ++word) {
+        for (std::uint64_t rest = words[word]; rest != 0; rest &= rest - 1) {
+            const std::uint32_t column = 64 * word + __builtin_ctzll(rest);
+            if (column != basics[index] && column != other && value(column) == 0)
+                return column;
+        }
+    }
+    return noColumn;
+}
+
+// Implied columns are assigned after every column assigned so far.
+std::uint32_t GaussMatrix::findLatest(std::size_t index) const {
+    const std::uint64_t * words = bits.data() + index * numberWords;
+    std::uint32_t latest = noColumn;
+    std::size_t latestLevel = 0;
+    for (std::size_t word = 0; word < numberWords; ++word) {
+        for (std::uint64_t rest = words[word]; rest != 0; rest &= rest - 1) {
+            const std::uint32_t column = 64 * word + __builtin_ctzll(rest);
+            if (column == basics[index])
+                continue;
+            const std::size_t level = implied[column] != 0 ? std::numeric_limits<std::size_t>::max() : levels[variables[column]];
+            if (latest == noColumn || level > latestLevel) {
+                latest = column;
+                latestLevel = level;
+            }
+        }
+    }
+    return latest;
+}
+
+void GaussMatrix::watch(std::size_t index, std::uint32_t column) {
+    watches[index] = column;
+    if (column != noColumn)
+        watchers[column].push_back(index);
+}
+
+void GaussMatrix::pivot(std::size_t index, std::uint32_t column) {
+    basics[index] = column;
+    watchers[column].push_back(index);
+
+    // Rows that are changed are collected first, so that their watches are restored once the
+    // matrix is in reduced row echelon form again.
+    changed.clear();
+    const std::uint64_t * source = row(index);
+    for (std::size_t other = 0; other < basics.size(); ++other) {
+        if (other == index || !contains(other, column))
+            continue;
+        std::uint64_t * target = row(other);
+        for (std::size_t word = 0; word < numberWords; ++word)
+            target[word] ^= source[word];
+        parities[other] ^= parities[index];
+        changed.push_back(other);
+    }
+    for (std::uint32_t other : changed)
+        refresh(other);
+}
+
+// A row whose basic column is assigned is left to the pending update of that column.
+void GaussMatrix::refresh(std::size_t index) {
+    const std::uint32_t watched = watches[index];
+    if (watched != noColumn && contains(index, watched) && value(watched) == 0)
+        return;
+    const std::uint32_t column = findUnassigned(index, noColumn);
+    if (column != noColumn) {
+        watch(index, column);
+        return;
+    }
+    // Every other column is assigned. Watching the one assigned last keeps the watches valid
+    // after backtracking.
+    watch(index, findLatest(index));
+    if (value(basics[index]) == 0)
+        record(index, basics[index]);
+}
+
+void GaussMatrix::record(std::size_t index, std::uint32_t column) {
+    const std::uint64_t * words = bits.data() + index * numberWords;
+    bool parity = parities[index];
+    const std::size_t start = clauseLiterals.size();
+    if (column != noColumn)
+        clauseLiterals.push_back(noLiteral);
+    for (std::size_t word = 0; word < numberWords; ++word) {
+        for (std::uint64_t rest = words[word]; rest != 0; rest &= rest - 1) {
+            const std::uint32_t other = 64 * word + __builtin_ctzll(rest);
+            if (other == column)
+                continue;
+            const bool isTrue = value(other) > 0;
+            parity ^= isTrue;
+            clauseLiterals.push_back(makeLiteral(variables[other], isTrue));
+        }
+    }
+    if (column != noColumn) {
+        // The implied column takes the value that restores the parity of the row.
+        clauseLiterals[start] = makeLiteral(variables[column], !parity);
+        implied[column] = parity ? 1 : -1;
+        impliedColumns.push_back(column);
+    }
+    clauseStarts.push_back(clauseLiterals.size());
+}
+
+bool GaussMatrix::assign(std::uint32_t variable) {
+    for (std::uint32_t column : impliedColumns)
+        implied[column] = 0;
+    impliedColumns.clear();
+    clauseLiterals.clear();
+    clauseStarts.assign(1, 0);
+    if (variable >= columns.size() || columns[variable] == noColumn)
+        return true;
+
+    const std::uint32_t column = columns[variable];
+    visiting.swap(watchers[column]);
+    watchers[column].clear();
+
+    for (std::size_t i = 0; i < visiting.size(); ++i) {
+        const std::uint32_t index = visiting[i];
+        if (basics[index] == column) {
+            // Make another unassigned column basic if there is one.
+            const std::uint32_t replacement = findUnassigned(index, watches[index]);
+            if (replacement != noColumn) {
+                pivot(index, replacement);
+                continue;
+            }
+            watchers[column].push_back(index);
+            if (watches[index] != noColumn && value(watches[index]) == 0) {
+                record(index, watches[index]);
+                continue;
+            }
+            const std::uint32_t latest = findLatest(index);
+            if (latest != watches[index])
+                watch(index, latest);
+        } else if (watches[index] == column) {
+            const std::uint32_t replacement = findUnassigned(index, noColumn);
+            if (replacement != noColumn) {
+                watch(index, replacement);
+                continue;
+            }
+            watchers[column].push_back(index);
+            if (value(basics[index]) == 0) {
+                record(index, basics[index]);
+                continue;
+            }
+        } else {
+            // The row no longer watches the column.
+            continue;
+        }
+
+        // Every column of the row is assigned. Check its parity.
+        const std::uint64_t * words = bits.data() + index * numberWords;
+        bool parity = parities[index];
+        for (std::size_t word = 0; word < numberWords; ++word) {
+            for (std::uint64_t rest = words[word]; rest != 0; rest &= rest - 1)
+                parity ^= value(64 * word + __builtin_ctzll(rest)) > 0;
+        }
+        if (parity) {
+            record(index, noColumn);
+            watchers[column].insert(watchers[column].end(), visiting.begin() + i + 1, visiting.end());
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef __MAPHGAUSS_HPP__
+#define __MAPHGAUSS_HPP__
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "maphClause.hpp"
+
+// A parity constraint: the exclusive or of the variables equals 'parity'.
+struct XorConstraint {
+    std::vector<std::uint32_t> variables;
+    bool parity;
+};
+
+// Recover the XOR constraints whose direct encodings occur among the clauses of 'formula' that
+// are not learned. An XOR of k variables is encoded by the 2^(k-1) clauses over its variables
+// with an odd (parity 0) or even (parity 1) number of negative literals. Only XORs of 3 to
+// 'maximumSize' variables are looked for.
+std::vector<XorConstraint> detectXors(const ClauseArena & arena, const std::vector<ClauseRef> & formula,
+    std::size_t maximumSize);
+
+// Propagates a system of XOR constraints by Gauss-Jordan elimination. The rows of the
+// matrix are bit sets over the columns, one per variable, stored in 64-bit words so that
+// adding one row to another takes one exclusive or per word. The matrix is kept in reduced
+// row echelon form: the basic column of each row occurs in no other row.
+//
+// Each row watches its basic column and one other column. As long as both are unassigned
+// the row cannot propagate. When the basic column is assigned, another unassigned column of
+// the row becomes basic and is eliminated from the other rows, so the basic columns stay
+// unassigned and every implied literal of the system is found. Row operations keep the
+// solutions of the system, so backtracking does not have to undo them.
+class GaussMatrix {
+
+    static constexpr std::uint32_t noColumn = ~std::uint32_t(0);
+
+    // The assignment of the solver and the decision levels of its variables.
+    const std::vector<signed char> & values;
+    const std::vector<std::size_t> & levels;
+
+    std::size_t numberWords;
+    std::vector<std::uint64_t> bits;
+    std::vector<char> parities;
+
+    // The column of each variable indexed by variable, or noColumn, and the variable of
+    // each column.
+    std::vector<std::uint32_t> columns;
+    std::vector<std::uint32_t> variables;
+
+    // The basic and the other watched column of each row, and the rows watching each column.
+    // A watch list may hold rows that no longer watch the column; they are dropped when the
+    // list is visited.
+    std::vector<std::uint32_t> basics;
+    std::vector<std::uint32_t> watches;
+    std::vector<std::vector<std::uint32_t> > watchers;
+    std::vector<std::uint32_t> visiting;
+    std::vector<std::uint32_t> changed;
+
+    // The values of the columns implied during the current call to 'assign', which the solver
+    // asserts afterwards, indexed by column: 1 if true, -1 if false and 0 if not implied.
+    std::vector<signed char> implied;
+    std::vector<std::uint32_t> impliedColumns;
+
+    // The clauses recorded by the current call to 'assign'. Clause i holds the literals of
+    // 'clauseLiterals' from 'clauseStarts[i]' to 'clauseStarts[i + 1]'.
+    std::vector<Literal> clauseLiterals;
+    std::vector<std::size_t> clauseStarts;
+
+    std::uint64_t * row(std::size_t index) { return bits.data() + index * numberWords; }
+    bool contains(std::size_t index, std::uint32_t column) const {
+        return (bits[index * numberWords + (column >> 6)] >> (column & 63)) & 1;
+    }
+
+    // The value of a column, including the values implied during the current call.
+    int value(std::uint32_t column) const {
+        const int v = values[variables[column]];
+        return v != 0 ? v : implied[column];
+    }
+
+    // An unassigned column of a row other than its basic column and 'other', or noColumn.
+    std::uint32_t findUnassigned(std::size_t index, std::uint32_t other) const;
+
+    // The column of a row other than its basic column that was assigned last, or noColumn.
+    std::uint32_t findLatest(std::size_t index) const;
+
+    void watch(std::size_t index, std::uint32_t column);
+
+    // Make 'column' the basic column of a row and eliminate it from the other rows.
+    void pivot(std::size_t index, std::uint32_t column);
+
+    // Restore the watches of a row after another row has been added to it.
+    void refresh(std::size_t index);
+
+    // Record the row as a clause. Its literals are false, except the literal of 'column' if
+    // it is not noColumn, which comes first and is implied by the others.
+    void record(std::size_t index, std::uint32_t column);
+
+public:
+
+    GaussMatrix(const std::vector<signed char> & values, const std::vector<std::size_t> & levels);
+
+    // Set up the matrix for 'xors' at level 0, leaving out the assigned variables. The literals
+    // implied by a single row are added to 'units'. Returns false if the system has no solution.
+    // Matrices with more than 'maximumWords' words are not built.
+    bool build(std::size_t numberVariables, const std::vector<XorConstraint> & xors, std::vector<Literal> & units);
+    static constexpr std::size_t maximumWords = 1 << 22;
+
+    // Forget all rows.
+    void clear();
+
+    bool empty() const { return basics.empty(); }
+
+    // Update the matrix once 'variable' has been assigned. Each row that became unit is recorded
+    // as a clause implying its last literal; the solver asserts them in order. Returns false if a
+    // row became false, in which case it is the last clause recorded.
+    bool assign(std::uint32_t variable);
+
+    std::size_t numberClauses() const { return clauseStarts.size() - 1; }
+    const Literal * clauseBegin(std::size_t index) const { return clauseLiterals.data() + clauseStarts[index]; }
+    const Literal * clauseEnd(std::size_t index) const { return clauseLiterals.data() + clauseStarts[index + 1]; }
+};
+
+#endif
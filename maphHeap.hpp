@@ -0,0 +1,108 @@
+#ifndef __MAPHHEAP_HPP__
+#define __MAPHHEAP_HPP__
+
+#include <cstdlib>
+#include <vector>
+
+// An indexed binary max-heap of variables ordered by their activity. The heap owns
+// the activities so that bumping a variable can restore the heap property in place.
+class VariableHeap {
+
+    // The activity of each variable indexed by variable.
+    std::vector<double> activities;
+
+    // The variables in heap order.
+    std::vector<int> heap;
+
+    // The position of each variable in 'heap', or -1 if the variable is not in the heap.
+    std::vector<int> positions;
+
+    bool greater(int a, int b) const {
+        return activities[a] > activities[b] || (activities[a] == activities[b] && a < b);
+    }
+
+    void siftUp(std::size_t position) {
+        const int variable = heap[position];
+        while (position > 0) {
+            const std::size_t parent = (position - 1) / 2;
+            if (!greater(variable, heap[parent]))
+                break;
+            heap[position] = heap[parent];
+            positions[heap[position]] = position;
+            position = parent;
+        }
+        heap[position] = variable;
+        positions[variable] = position;
+    }
+
+    void siftDown(std::size_t position) {
+        const int variable = heap[position];
+        while (2 * position + 1 < heap.size()) {
+            std::size_t child = 2 * position + 1;
+            if (child + 1 < heap.size() && greater(heap[child + 1], heap[child]))
+                ++child;
+            if (!greater(heap[child], variable))
+                break;
+            heap[position] = heap[child];
+            positions[heap[position]] = position;
+            position = child;
+        }
+        heap[position] = variable;
+        positions[variable] = position;
+    }
+
+public:
+
+    // Create an empty heap for the variables 1 to 'numberVariables'.
+    explicit VariableHeap(std::size_t numberVariables = 0) :
+        activities(numberVariables + 1, 0.0), positions(numberVariables + 1, -1) {}
+
+    // Make room for the variables up to 'numberVariables'. The new variables are not inserted.
+    void grow(std::size_t numberVariables) {
+        if (numberVariables + 1 > activities.size()) {
+            activities.resize(numberVariables + 1, 0.0);
+            positions.resize(numberVariables + 1, -1);
+        }
+    }
+
+    bool empty() const { return heap.empty(); }
+
+    bool contains(int variable) const { return positions[variable] >= 0; }
+
+    double activity(int variable) const { return activities[variable]; }
+
+    // Insert 'variable' unless it is already in the heap.
+    void insert(int variable) {
+        if (contains(variable))
+            return;
+        positions[variable] = heap.size();
+        heap.push_back(variable);
+        siftUp(heap.size() - 1);
+    }
+
+    // Remove and return the variable with the highest activity.
+    int removeMax() {
+        const int variable = heap.front();
+        positions[variable] = -1;
+        heap.front() = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+            siftDown(0);
+        return variable;
+    }
+
+    // Add 'amount' to the activity of 'variable' and restore the heap property.
+    void bump(int variable, double amount) {
+        activities[variable] += amount;
+        if (contains(variable))
+            siftUp(positions[variable]);
+    }
+
+    // Multiply every activity by 'factor'. Scaling preserves the heap order.
+    void rescale(double factor) {
+        for (double & activity : activities)
+            activity *= factor;
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+
+#include "maphLocal.hpp"
+
+constexpr std::uint32_t LocalSearch::noPosition;
+constexpr std::size_t LocalSearch::weightTableSize;
+
+// The weights follow the ProbSAT paper (Balint and Schöning, 2012): a polynomial in the break
+// count for 3-SAT and an exponential one for longer clauses, whose base grows with their length.
+LocalSearch::LocalSearch(std::size_t numberVariables, const ClauseArena & arena, const std::vector<ClauseRef> & formula,
+    const std::vector<signed char> & values, RandomGenerator & generator) :
+    numberVariables(numberVariables), arena(arena), occurrences(2 * numberVariables + 2),
+    assignment(numberVariables + 1, 0), fixed(numberVariables + 1, 0), breaks(numberVariables + 1, 0),
+    bestUnsatisfied(0), overflow(false), generator(generator) {
+    for (std::size_t variable = 1; variable <= numberVariables; ++variable) {
+        fixed[variable] = values[variable] != 0;
+        assignment[variable] = values[variable] > 0;
+    }
+
+    std::size_t maximumLength = 0;
+    for (ClauseRef ref : formula) {
+        const auto clause = arena[ref];
+        if (clause.learned() || clause.deleted())
+            continue;
+        bool satisfied = false;
+        bool free = false;
+        for (Literal literal : clause) {
+            const int value = values[variableOf(literal)];
+            satisfied = satisfied || (isNegative(literal) ? value < 0 : value > 0);
+            free = free || value == 0;
+        }
+        if (satisfied || !free)
+            continue;
+        const std::uint32_t index = clauses.size();
+        clauses.push_back(ref);
+        for (Literal literal : clause) {
+            if (!fixed[variableOf(literal)])
+                occurrences[literal].push_back(index);
+        }
+        maximumLength = std::max<std::size_t>(maximumLength, clause.size());
+    }
+
+    trueCount.assign(clauses.size(), 0);
+    trueVariables.assign(clauses.size(), 0);
+    positions.assign(clauses.size(), noPosition);
+    unsatisfied.reserve(clauses.size());
+
+    weights.resize(weightTableSize);
+    for (std::size_t breakCount = 0; breakCount < weightTableSize; ++breakCount) {
+        if (maximumLength <= 3)
+            weights[breakCount] = std::pow(0.9 + breakCount, -2.06);
+        else {
+            const double base = maximumLength == 4 ? 3.0 : maximumLength == 5 ? 3.7 : maximumLength == 6 ? 5.1 : 5.4;
+            weights[breakCount] = std::pow(base, -static_cast<double>(breakCount));
+        }
+    }
+}
+
+void LocalSearch::makeUnsatisfied(std::uint32_t clause) {
+    positions[clause] = unsatisfied.size();
+    unsatisfied.push_back(clause);
+}
+
+// Move the last unsatisfied clause into the place of the one that became satisfied.
+void LocalSearch::makeSatisfied(std::uint32_t clause) {
+    const std::uint32_t last = unsatisfied.back();
+    unsatisfied[positions[clause]] = last;
+    positions[last] = positions[clause];
+    unsatisfied.pop_back();
+    positions[clause] = noPosition;
+}
+
+void LocalSearch::initialize(const std::vector<signed char> & phases) {
+    for (std::size_t variable = 1; variable <= numberVariables; ++variable) {
+        if (!fixed[variable])
+            assignment[variable] = phases[variable] != 0 ? phases[variable] > 0 : generator() & 1;
+    }
+
+    std::fill(breaks.begin(), breaks.end(), 0);
+    unsatisfied.clear();
+    for (std::uint32_t index = 0; index < clauses.size(); ++index) {
+        trueCount[index] = 0;
+        trueVariables[index] = 0;
+        positions[index] = noPosition;
+        for (Literal literal : arena[clauses[index]]) {
+            const std::uint32_t variable = variableOf(literal);
+            if (!fixed[variable] && assignment[variable] != isNegative(literal)) {
+                ++trueCount[index];
+                trueVariables[index] ^= variable;
+            }
+        }
+        if (trueCount[index] == 0)
+            makeUnsatisfied(index);
+        else if (trueCount[index] == 1)
+            ++breaks[trueVariables[index]];
+    }
+
+    best = assignment;
+    bestUnsatisfied = unsatisfied.size();
+    flipped.clear();
+    overflow = false;
+}
+
+void LocalSearch::flip(std::uint32_t variable) {
+    const Literal satisfied = makeLiteral(variable, assignment[variable]);
+    assignment[variable] ^= 1;
+
+    for (std::uint32_t clause : occurrences[satisfied]) {
+        if (trueCount[clause] == 0) {
+            makeSatisfied(clause);
+            ++breaks[variable];
+        } else if (trueCount[clause] == 1) {
+            --breaks[trueVariables[clause]];
+        }
+        ++trueCount[clause];
+        trueVariables[clause] ^= variable;
+    }
+    for (std::uint32_t clause : occurrences[negate(satisfied)]) {
+        trueVariables[clause] ^= variable;
+        --trueCount[clause];
+        if (trueCount[clause] == 0) {
+            makeUnsatisfied(clause);
+            --breaks[variable];
+        } else if (trueCount[clause] == 1) {
+            ++breaks[trueVariables[clause]];
+        }
+    }
+}
+
+// Only the variables flipped since the best assignment was last recorded are copied into it.
+// Once more flips than variables have been logged, the whole assignment is copied instead.
+void LocalSearch::recordBest() {
+    if (overflow)
+        best = assignment;
+    else {
+        for (std::uint32_t variable : flipped)
+            best[variable] = assignment[variable];
+    }
+    flipped.clear();
+    overflow = false;
+    bestUnsatisfied = unsatisfied.size();
+}
+
+bool LocalSearch::run(std::size_t flips) {
+    for (std::size_t step = 0; step < flips && !unsatisfied.empty(); ++step) {
+        const std::uint32_t clause = unsatisfied[generator.below(unsatisfied.size())];
+        const auto literals = arena[clauses[clause]];
+
+        // Pick a variable of the clause with a probability proportional to its weight.
+        candidateWeights.clear();
+        double sum = 0.0;
+        for (Literal literal : literals) {
+            const std::uint32_t variable = variableOf(literal);
+            const double weight =
+                fixed[variable] ? 0.0 : weights[std::min<std::size_t>(breaks[variable], weightTableSize - 1)];
+            candidateWeights.push_back(weight);
+            sum += weight;
+        }
+        double threshold = generator.uniform() * sum;
+        std::uint32_t chosen = 0;
+        for (std::size_t index = 0; index < literals.size(); ++index) {
+            if (candidateWeights[index] == 0.0)
+                continue;
+            chosen = variableOf(literals[index]);
+            threshold -= candidateWeights[index];
+            if (threshold < 0.0)
+                break;
+        }
+
+        flip(chosen);
+        if (!overflow) {
+            flipped.push_back(chosen);
+            overflow = flipped.size() > numberVariables;
+            if (overflow)
+                flipped.clear();
+        }
+        if (unsatisfied.size() < bestUnsatisfied)
+            recordBest();
+    }
+    return unsatisfied.empty();
+}
@@ -0,0 +1,96 @@
+#ifndef __MAPHLOCAL_HPP__
+#define __MAPHLOCAL_HPP__
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "maphClause.hpp"
+#include "maphRandom.hpp"
+
+// Stochastic local search with the ProbSAT algorithm. Starting from a complete assignment,
+// it repeatedly picks a random unsatisfied clause and flips one of its variables, chosen
+// with a probability that falls with the number of clauses the flip would break. It works
+// on the clauses of the solver's arena in place.
+class LocalSearch {
+
+    std::size_t numberVariables;
+    const ClauseArena & arena;
+
+    // The clauses that are not satisfied at level 0, and for each literal the indices in
+    // 'clauses' of the clauses containing it. Variables assigned at level 0 are never
+    // flipped, so their literals are left out.
+    std::vector<ClauseRef> clauses;
+    std::vector<std::vector<std::uint32_t> > occurrences;
+
+    // The current assignment indexed by variable: 1 if true and 0 if false.
+    std::vector<char> assignment;
+
+    // Whether each variable has been assigned at level 0, indexed by variable.
+    std::vector<char> fixed;
+
+    // The number of true literals of each clause, and the exclusive or of their variables,
+    // which is the only true variable of a clause with one true literal.
+    std::vector<std::uint32_t> trueCount;
+    std::vector<std::uint32_t> trueVariables;
+
+    // The number of clauses that each variable is the only true variable of, which become
+    // unsatisfied if it is flipped.
+    std::vector<std::uint32_t> breaks;
+
+    // The unsatisfied clauses and the position of each clause in 'unsatisfied', or
+    // 'noPosition' if it is satisfied.
+    std::vector<std::uint32_t> unsatisfied;
+    std::vector<std::uint32_t> positions;
+    static constexpr std::uint32_t noPosition = ~std::uint32_t(0);
+
+    // The weight of a variable with a given break count. Larger break counts share the
+    // weight of the last entry.
+    std::vector<double> weights;
+    static constexpr std::size_t weightTableSize = 64;
+
+    // The weights of the literals of the clause being repaired.
+    std::vector<double> candidateWeights;
+
+    // The assignment with the fewest unsatisfied clauses found so far.
+    std::vector<char> best;
+    std::size_t bestUnsatisfied;
+
+    // The variables flipped since the best assignment was recorded, unless there have been
+    // more of them than variables ('overflow').
+    std::vector<std::uint32_t> flipped;
+    bool overflow;
+
+    // The generator of the solver.
+    RandomGenerator & generator;
+
+    void makeUnsatisfied(std::uint32_t clause);
+    void makeSatisfied(std::uint32_t clause);
+
+    // Make the current assignment the best one.
+    void recordBest();
+
+    // Flip a variable and update the counts of the clauses containing it.
+    void flip(std::uint32_t variable);
+
+public:
+
+    // Set up the search on the clauses of 'formula' that are not learned. 'values' holds the
+    // assignment at level 0, indexed by variable: 1 if true, -1 if false and 0 if unassigned.
+    LocalSearch(std::size_t numberVariables, const ClauseArena & arena, const std::vector<ClauseRef> & formula,
+        const std::vector<signed char> & values, RandomGenerator & generator);
+
+    // Start from the given phases, indexed by variable. Variables with phase 0 start with a
+    // random value.
+    void initialize(const std::vector<signed char> & phases);
+
+    // Flip until every clause is satisfied or 'flips' flips have been made. Returns true if
+    // the current assignment satisfies every clause.
+    bool run(std::size_t flips);
+
+    // The assignment with the fewest unsatisfied clauses found so far, indexed by variable:
+    // 1 if true and 0 if false.
+    const std::vector<char> & bestAssignment() const { return best; }
+};
+
+#endif
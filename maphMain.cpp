@@ -1,7 +1,17 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 
+#include <signal.h>
+#include <unistd.h>
+
+#include "maphBatch.hpp"
+#include "maphCube.hpp"
+#include "maphPortfolio.hpp"
 #include "maphSat.hpp"
 
 void printError(char * prog) {
@@ -12,32 +22,158 @@ void printError(char * prog) {
 ██║╚██╔╝██║██╔══██║██╔═══╝ ██╔══██║╚════██║██║   ██║██║     ╚██╗ ██╔╝██╔══╝  ██╔══██╗
 ██║ ╚═╝ ██║██║  ██║██║     ██║  ██║███████║╚██████╔╝███████╗ ╚████╔╝ ███████╗██║  ██║
 ╚═╝     ╚═╝╚═╝  ╚═╝╚═╝     ╚═╝  ╚═╝╚══════╝ ╚═════╝ ╚══════╝  ╚═══╝  ╚══════╝╚═╝  ╚═╝
-    )" << "\nUsage: " << prog << " <DIMACS file>" << " selection heuristic:\n <FIRST=0 | RANDOM=1 | DLIS=2 | RDLIS=3 | DLCS=4 | RDLCS=5 | JW=6 | RJW=7 | MOMS=8 | RMOMS=9>\n\n"
+    )" << "\nUsage: " << prog << " <DIMACS file>" << " selection heuristic [options]\n"
+    << "       " << prog << " --batch <file listing DIMACS files | -> selection heuristic [options]\n"
+    << "       " << prog << " --serve <Unix socket path | -> selection heuristic [options]\n"
+    << "Selection heuristics:\n <FIRST=0 | RANDOM=1 | DLIS=2 | RDLIS=3 | DLCS=4 | RDLCS=5 | JW=6 | RJW=7 | MOMS=8 | RMOMS=9 | VSIDS=10>\n\n"
     << "Available selection heuristics: \n" << "- FIRST: select the first available literal\n"
     << "- RANDOM: select a random literal\n" << "- DLIS: Dynamic Largest Individual Sum\n" << "- RDLIS: randomized Dynamic Largest Individual Sum\n"
     << "- DLCS: Dynamic Largest Combined Sum\n" << "- RDLCS: randomized Dynamic Largest Combined Sum\n" << "- JW: Jeroslow-Wang heuristic\n"
     << "- RJW: randomized Jeroslow-Wang heuristic\n" << "- MOMS: Maximum [number of] Occurrences in Minimum [length] Clauses\n"
-    << "- RMOMS: randomized Maximum [number of] Occurrences in Minimum [length] Clauses\n";
+    << "- RMOMS: randomized Maximum [number of] Occurrences in Minimum [length] Clauses\n"
+    << "- VSIDS: Variable State Independent Decaying Sum\n\n"
+    << "Options:\n"
+    << "  --restarts <none | luby | glucose>  restart policy (default: none)\n"
+    << "  --phase-saving                      reuse the last polarity of each variable when deciding\n"
+    << "  --keep-learned                      never delete learned clauses\n"
+    << "  --preprocess                        simplify the formula before the search\n"
+    << "  --inprocess                         periodically simplify the formula during the search\n"
+    << "  --gauss                             propagate the XOR constraints by Gaussian elimination\n"
+    << "  --pure-literals                     decide pure literals before the selection heuristic\n"
+    << "  --local-search <phases | only>      seed the saved phases by local search, or solve by it alone\n"
+    << "  --seed <n>                          seed the random choices of the solver (default: 0)\n"
+    << "  --threads <n>                       run n differently configured solvers in parallel\n"
+    << "  --cubes                             split the formula into cubes solved by --threads workers\n"
+    << "  --conflict-limit <n>                give up after n conflicts\n"
+    << "  --propagation-limit <n>             give up after n propagations\n"
+    << "  --time-limit <seconds>              give up this many seconds after reading the formula starts\n"
+    << "  --memory-limit <MB>                 give up once the resident memory reaches this many megabytes\n"
+    << "  --verbose                           print progress and statistics as comment lines\n\n"
+    << "Batch mode solves the DIMACS files listed one per line in a file, or on the standard input for '-'.\n"
+    << "Server mode solves DIMACS texts, each preceded by a line with its length in bytes, sent to a Unix\n"
+    << "socket or on the standard input for '-'. Both write one line per formula:\n"
+    << "  <job number> <SATISFIABLE | UNSATISFIABLE | UNKNOWN | ERROR> <seconds> <path>\n"
+    << "and solve --threads formulas at once.\n";
+}
+
+// Stop the search and report what is known so far. The default action is restored, so a
+// second signal terminates the programme.
+extern "C" void handleSignal(int) {
+    MaphSAT::interruptAll();
 }
 
 int main(int argc, char ** argv) {
-    if (argc < 3) {
+    // In batch and server mode, the DIMACS file is replaced by the source of the formulas.
+    const bool batch = argc > 1 && std::strcmp(argv[1], "--batch") == 0;
+    const bool serve = argc > 1 && std::strcmp(argv[1], "--serve") == 0;
+    const int first = batch || serve ? 2 : 1;
+    if (argc < first + 2) {
         printError(argv[0]);
         return 1;
     }
 
-    std::ifstream stream(argv[1]);
-    const int heuristic = atoi(argv[2]);
+    const char * input = argv[first];
+    const int heuristic = atoi(argv[first + 1]);
 
-    if (stream.fail() || heuristic < 0 || heuristic > 9) {
+    if (heuristic < 0 || heuristic > 10) {
         printError(argv[0]);
         return 1;
     }
 
-    MaphSAT solver(stream, static_cast<MaphSAT::Heuristic>(heuristic));
+    MaphSAT::Options options;
+    bool verbose = false;
+    std::size_t threads = 1;
+    bool cubes = false;
+    for (int i = first + 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--cubes") == 0)
+            cubes = true;
+        else if (std::strcmp(argv[i], "--verbose") == 0)
+            verbose = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            threads = atoi(argv[++i]);
+        else if (!options.parse(argv, argc, i)) {
+            printError(argv[0]);
+            return 1;
+        }
+    }
+
+    if (batch || serve) {
+        BatchSolver batchSolver(static_cast<MaphSAT::Heuristic>(heuristic), options, threads);
+        if (batch && std::strcmp(input, "-") == 0) {
+            batchSolver.solveList(std::cin, STDOUT_FILENO);
+        } else if (batch) {
+            std::ifstream list(input);
+            if (!list) {
+                printError(argv[0]);
+                return 1;
+            }
+            batchSolver.solveList(list, STDOUT_FILENO);
+        } else if (std::strcmp(input, "-") == 0) {
+            if (!batchSolver.serve(STDIN_FILENO, STDOUT_FILENO)) {
+                std::cerr << "Malformed job on the standard input.\n";
+                return 1;
+            }
+        } else if (!batchSolver.listen(input)) {
+            std::cerr << "Cannot listen on " << input << ".\n";
+            return 1;
+        }
+        return 0;
+    }
 
-    solver.solve();
-    std::cout << solver;
+    DimacsParser parser(input);
+    if (!parser.isOpen()) {
+        printError(argv[0]);
+        return 1;
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handleSignal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (int signal : {SIGINT, SIGTERM, SIGXCPU})
+        sigaction(signal, &action, nullptr);
+
+    const auto printParseTime = [&parser, verbose](double seconds) {
+        if (verbose) {
+            const double megabytes = parser.size() / 1e6;
+            std::cout << std::fixed << std::setprecision(2) << "c parsed " << megabytes << " MB in "
+                      << seconds << " s (" << megabytes / std::max(seconds, 1e-9) << " MB/s)\n"
+                      << std::defaultfloat << std::flush;
+        }
+    };
+
+    if (cubes || threads > 1) {
+        // The formula is parsed once and every solver sets itself up from it.
+        const auto start = std::chrono::steady_clock::now();
+        Formula formula;
+        parser.read(formula);
+        printParseTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        if (cubes) {
+            CubeAndConquer cubeAndConquer(formula, threads, static_cast<MaphSAT::Heuristic>(heuristic), options);
+            cubeAndConquer.solve();
+            std::cout << cubeAndConquer;
+        } else {
+            Portfolio portfolio(formula, threads, static_cast<MaphSAT::Heuristic>(heuristic), options);
+            portfolio.solve();
+            std::cout << portfolio;
+        }
+    } else {
+        // A single solver reports its progress during the search and its statistics at the end,
+        // which are also printed if it stops without an answer.
+        options.progress = verbose;
+        options.timePhases = verbose;
+        // The solver preprocesses the formula as soon as it has read it, so it measures the parse
+        // time itself.
+        MaphSAT solver(parser, static_cast<MaphSAT::Heuristic>(heuristic), options);
+        printParseTime(solver.phaseTimes().parse);
+
+        solver.solve();
+        if (verbose || solver.limitReached() != MaphSAT::Limit::NONE)
+            solver.printStatistics(std::cout);
+        std::cout << solver;
+    }
 
     if (std::cout.bad()) {
         std::cerr << "Error while printing.\n";
@@ -0,0 +1,104 @@
+#include <thread>
+
+#include "maphPortfolio.hpp"
+
+namespace {
+
+// The configurations of the threads other than the first. Each one is used with the
+// options selected by the user, a different seed and the settings below.
+struct Configuration {
+    MaphSAT::Heuristic heuristic;
+    RestartScheduler::Policy restarts;
+    bool phaseSaving;
+    bool preprocess;
+};
+
+const Configuration configurations[] = {
+    {MaphSAT::Heuristic::VSIDS, RestartScheduler::Policy::GLUCOSE, true, false},
+    {MaphSAT::Heuristic::VSIDS, RestartScheduler::Policy::LUBY, true, false},
+    {MaphSAT::Heuristic::VSIDS, RestartScheduler::Policy::GLUCOSE, false, false},
+    {MaphSAT::Heuristic::VSIDS, RestartScheduler::Policy::LUBY, true, true},
+    {MaphSAT::Heuristic::JW, RestartScheduler::Policy::LUBY, false, false},
+    {MaphSAT::Heuristic::DLIS, RestartScheduler::Policy::LUBY, false, false},
+    {MaphSAT::Heuristic::MOMS, RestartScheduler::Policy::LUBY, false, false}
+};
+
+}
+
+Portfolio::Portfolio(const Formula & formula, std::size_t numberThreads, MaphSAT::Heuristic heuristic,
+    const MaphSAT::Options & options) :
+    formula(formula), numberThreads(numberThreads), heuristic(heuristic), options(options),
+    solvers(numberThreads), winner(-1), satisfiable(false) {
+    for (std::size_t thread = 0; thread < numberThreads; ++thread)
+        buffers.emplace_back(new ClauseBuffer());
+}
+
+void Portfolio::configure(std::size_t thread, MaphSAT::Heuristic & threadHeuristic,
+    MaphSAT::Options & threadOptions) const {
+    threadHeuristic = heuristic;
+    threadOptions = options;
+    if (thread == 0)
+        return;
+
+    const std::size_t number = sizeof(configurations) / sizeof(configurations[0]);
+    const Configuration & configuration = configurations[(thread - 1) % number];
+    threadHeuristic = configuration.heuristic;
+    threadOptions.restarts = configuration.restarts;
+    threadOptions.phaseSaving = configuration.phaseSaving;
+    threadOptions.preprocess = options.preprocess || configuration.preprocess;
+    threadOptions.seed = options.seed + thread;
+}
+
+void Portfolio::run(std::size_t thread) {
+    MaphSAT::Heuristic threadHeuristic;
+    MaphSAT::Options threadOptions;
+    configure(thread, threadHeuristic, threadOptions);
+
+    std::unique_ptr<MaphSAT> solver(new MaphSAT(formula, threadHeuristic, threadOptions));
+    std::vector<const ClauseBuffer *> imports;
+    for (std::size_t other = 0; other < numberThreads; ++other) {
+        if (other != thread)
+            imports.push_back(buffers[other].get());
+    }
+    solver->shareClauses(buffers[thread].get(), imports);
+
+    MaphSAT * running = solver.get();
+    {
+        std::lock_guard<std::mutex> lock(solversMutex);
+        solvers[thread] = std::move(solver);
+        if (winner.load() != -1)
+            running->interrupt();
+    }
+
+    const bool result = running->solve();
+    if (!running->isSolved())
+        return;
+
+    int none = -1;
+    if (winner.compare_exchange_strong(none, static_cast<int>(thread))) {
+        satisfiable = result;
+        std::lock_guard<std::mutex> lock(solversMutex);
+        for (const auto & other : solvers) {
+            if (other && other.get() != running)
+                other->interrupt();
+        }
+    }
+}
+
+// Solve the formula using all threads.
+bool Portfolio::solve() {
+    std::vector<std::thread> threads;
+    for (std::size_t thread = 0; thread < numberThreads; ++thread)
+        threads.emplace_back(&Portfolio::run, this, thread);
+    for (std::thread & thread : threads)
+        thread.join();
+
+    return winner.load() != -1 && satisfiable;
+}
+
+std::ostream & operator<<(std::ostream & out, const Portfolio & portfolio) {
+    const int winner = portfolio.winner.load();
+    if (winner == -1)
+        return out << "s UNKNOWN\n";
+    return out << *portfolio.solvers[winner];
+}
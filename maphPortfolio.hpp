@@ -0,0 +1,57 @@
+#ifndef __MAPHPORTFOLIO_HPP__
+#define __MAPHPORTFOLIO_HPP__
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "maphDimacs.hpp"
+#include "maphSat.hpp"
+#include "maphShare.hpp"
+
+// Runs several differently configured solvers on the same formula in parallel threads.
+// The solvers exchange short learned clauses, and the first one to find an answer stops
+// the others.
+class Portfolio {
+
+    const Formula & formula;
+    std::size_t numberThreads;
+    MaphSAT::Heuristic heuristic;
+    MaphSAT::Options options;
+
+    // The solvers and the buffers of the clauses they export, indexed by thread. A solver
+    // is set up by its own thread, so it is null until its setup has finished.
+    std::vector<std::unique_ptr<MaphSAT> > solvers;
+    std::vector<std::unique_ptr<ClauseBuffer> > buffers;
+
+    // The index of the first solver that found an answer, or -1, and its answer.
+    std::atomic<int> winner;
+    bool satisfiable;
+
+    // Guards 'solvers' so that a solver that is set up after the answer has been found is
+    // stopped as well.
+    std::mutex solversMutex;
+
+    // The heuristic and options of the solver run by a thread. Thread 0 uses the ones
+    // selected by the user, the others cycle through a fixed list of configurations.
+    void configure(std::size_t thread, MaphSAT::Heuristic & heuristic, MaphSAT::Options & options) const;
+
+    // Set up and run the solver of a thread.
+    void run(std::size_t thread);
+
+public:
+
+    Portfolio(const Formula & formula, std::size_t numberThreads, MaphSAT::Heuristic heuristic,
+        const MaphSAT::Options & options);
+
+    // Solve the formula using all threads.
+    bool solve();
+
+    // Print the answer of the solver that finished first.
+    friend std::ostream & operator<<(std::ostream &, const Portfolio &);
+};
+
+#endif
@@ -0,0 +1,364 @@
+#include <algorithm>
+
+#include "maphPreprocess.hpp"
+
+constexpr std::size_t Preprocessor::stepLimit;
+constexpr std::size_t Preprocessor::clockInterval;
+constexpr std::size_t Preprocessor::occurrenceLimit;
+constexpr std::size_t Preprocessor::resolventLimit;
+constexpr Literal Preprocessor::noSubsumption;
+
+// Extend a model to the removed clauses, visiting them in the reverse order of their removal.
+// A variable eliminated later may occur in the clauses of a variable eliminated earlier, so
+// its value has to be fixed first.
+void ReconstructionStack::extend(std::vector<signed char> & values) const {
+    std::size_t end = literals.size();
+    while (end > 0) {
+        const std::size_t size = literals[end - 1];
+        const std::size_t first = end - 1 - size;
+        bool satisfied = false;
+        for (std::size_t i = first; i < end - 1 && !satisfied; ++i) {
+            const int value = values[variableOf(literals[i])];
+            satisfied = isNegative(literals[i]) ? value < 0 : value > 0;
+        }
+        if (!satisfied)
+            values[variableOf(literals[first])] = isNegative(literals[first]) ? -1 : 1;
+        end = first;
+    }
+}
+
+Preprocessor::Preprocessor(std::size_t numberVariables, ClauseArena & arena, std::vector<ClauseRef> & formula,
+    ReconstructionStack & reconstruction, std::chrono::steady_clock::time_point deadline) :
+    numberVariables(numberVariables), arena(arena), formula(formula), reconstruction(reconstruction),
+    unsatisfiable(false), unitHead(0), values(numberVariables + 1, 0), eliminated(numberVariables + 1, 0),
+    occurrences(2 * numberVariables + 2), literalStamps(2 * numberVariables + 2, 0), currentStamp(0), steps(0),
+    deadline(deadline), nextClockCheck(0), pastDeadline(false) {
+    signatures.reserve(formula.size());
+    queued.assign(formula.size(), 1);
+    for (std::size_t index = 0; index < formula.size(); ++index) {
+        for (Literal literal : clause(index))
+            occurrences[literal].push_back(index);
+        signatures.push_back(computeSignature(index));
+        subsumptionQueue.push_back(index);
+    }
+    // Short clauses are more likely to subsume others, so they are dequeued first.
+    std::sort(subsumptionQueue.begin(), subsumptionQueue.end(), [this](std::size_t a, std::size_t b) {
+        return clause(a).size() > clause(b).size();
+    });
+}
+
+std::uint64_t Preprocessor::computeSignature(std::size_t index) {
+    std::uint64_t signature = 0;
+    for (Literal literal : clause(index))
+        signature |= std::uint64_t(1) << (variableOf(literal) % 64);
+    return signature;
+}
+
+// Assign a literal at level 0.
+void Preprocessor::assign(Literal literal) {
+    if (value(literal) == -1)
+        unsatisfiable = true;
+    else if (value(literal) == 0) {
+        values[variableOf(literal)] = isNegative(literal) ? -1 : 1;
+        units.push_back(literal);
+    }
+}
+
+// Remove satisfied clauses and falsified literals for the literals assigned at level 0.
+void Preprocessor::propagate() {
+    while (unitHead < units.size() && !unsatisfiable) {
+        const Literal literal = units[unitHead++];
+        for (std::size_t index : occurrences[literal])
+            removeClause(index);
+        occurrences[literal].clear();
+
+        const std::vector<std::size_t> falsified = std::move(occurrences[negate(literal)]);
+        occurrences[negate(literal)].clear();
+        for (std::size_t index : falsified) {
+            if (!clause(index).deleted())
+                strengthen(index, negate(literal));
+        }
+    }
+}
+
+// Add a clause to the formula, or assign it if it is a unit clause. A clause subsumed by a
+// clause of the formula is not added.
+void Preprocessor::addClause(std::vector<Literal> & literals) {
+    if (forwardSubsumed(literals))
+        return;
+    if (literals.empty()) {
+        unsatisfiable = true;
+    } else if (literals.size() == 1) {
+        assign(literals[0]);
+    } else {
+        const std::size_t index = formula.size();
+        formula.push_back(arena.allocate(literals.begin(), literals.end(), false));
+        for (Literal literal : literals)
+            occurrences[literal].push_back(index);
+        signatures.push_back(computeSignature(index));
+        queued.push_back(0);
+        enqueue(index);
+    }
+}
+
+void Preprocessor::removeClause(std::size_t index) {
+    clause(index).markDeleted();
+}
+
+// Remove 'literal' from a clause. A clause that becomes a unit clause is assigned instead.
+void Preprocessor::strengthen(std::size_t index, Literal literal) {
+    const Clause strengthened = clause(index);
+    *std::find(strengthened.begin(), strengthened.end(), literal) = strengthened[strengthened.size() - 1];
+    strengthened.shrink(strengthened.size() - 1);
+
+    auto & clauses = occurrences[literal];
+    const auto position = std::find(clauses.begin(), clauses.end(), index);
+    if (position != clauses.end())
+        clauses.erase(position);
+    steps += strengthened.size() + clauses.size();
+
+    if (strengthened.size() == 1) {
+        assign(strengthened[0]);
+        removeClause(index);
+    } else {
+        signatures[index] = computeSignature(index);
+        enqueue(index);
+    }
+}
+
+void Preprocessor::enqueue(std::size_t index) {
+    if (!queued[index]) {
+        queued[index] = 1;
+        subsumptionQueue.push_back(index);
+    }
+}
+
+// Does the first clause subsume the second, possibly after flipping one of its literals?
+Literal Preprocessor::subsumes(std::size_t first, std::size_t second) {
+    ++currentStamp;
+    for (Literal literal : clause(second))
+        literalStamps[literal] = currentStamp;
+    steps += clause(first).size() + clause(second).size();
+
+    Literal flipped = noLiteral;
+    for (Literal literal : clause(first)) {
+        if (literalStamps[literal] == currentStamp)
+            continue;
+        if (flipped != noLiteral || literalStamps[negate(literal)] != currentStamp)
+            return noSubsumption;
+        flipped = literal;
+    }
+    return flipped;
+}
+
+// Remove or strengthen the clauses subsumed by a clause. Every such clause contains the
+// literal of the clause with the fewest occurrences, or its negation.
+void Preprocessor::backwardSubsume(std::size_t index) {
+    const Clause subsuming = clause(index);
+    if (subsuming.deleted())
+        return;
+
+    Literal best = subsuming[0];
+    for (Literal literal : subsuming) {
+        if (occurrences[literal].size() + occurrences[negate(literal)].size() <
+            occurrences[best].size() + occurrences[negate(best)].size())
+            best = literal;
+    }
+
+    for (Literal literal : {best, negate(best)}) {
+        // Strengthening changes the occurrence lists, so iterate over a copy. Every candidate
+        // counts as a step, even if its signature rules it out.
+        const std::vector<std::size_t> candidates = occurrences[literal];
+        steps += candidates.size();
+        for (std::size_t candidate : candidates) {
+            if (candidate == index || clause(candidate).deleted() || clause(candidate).size() < subsuming.size() ||
+                (signatures[index] & ~signatures[candidate]) != 0)
+                continue;
+            const Literal flipped = subsumes(index, candidate);
+            if (flipped == noLiteral)
+                removeClause(candidate);
+            else if (flipped != noSubsumption)
+                strengthen(candidate, negate(flipped));
+            if (unsatisfiable || outOfBudget())
+                return;
+        }
+    }
+}
+
+// Is a new clause subsumed by a clause of the formula? Every literal of a subsuming clause
+// occurs in the new clause, and so does every literal but one of a clause that strengthens
+// it, so both are found in the occurrence lists of its literals. Once a literal has been
+// removed, the lists are searched again.
+bool Preprocessor::forwardSubsumed(std::vector<Literal> & literals) {
+    bool strengthened = true;
+    while (strengthened) {
+        strengthened = false;
+        ++currentStamp;
+        std::uint64_t signature = 0;
+        for (Literal literal : literals) {
+            literalStamps[literal] = currentStamp;
+            signature |= std::uint64_t(1) << (variableOf(literal) % 64);
+        }
+        for (std::size_t i = 0; i < literals.size() && !strengthened; ++i) {
+            for (std::size_t index : occurrences[literals[i]]) {
+                const Clause candidate = clause(index);
+                if (candidate.deleted() || candidate.size() > literals.size() || (signatures[index] & ~signature) != 0)
+                    continue;
+                steps += candidate.size();
+                Literal flipped = noLiteral;
+                bool subsuming = true;
+                for (Literal literal : candidate) {
+                    if (literalStamps[literal] == currentStamp)
+                        continue;
+                    if (flipped != noLiteral || literalStamps[negate(literal)] != currentStamp) {
+                        subsuming = false;
+                        break;
+                    }
+                    flipped = literal;
+                }
+                if (!subsuming)
+                    continue;
+                if (flipped == noLiteral)
+                    return true;
+                literals.erase(std::find(literals.begin(), literals.end(), negate(flipped)));
+                strengthened = true;
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+// Has the work limit or the deadline been reached?
+bool Preprocessor::outOfBudget() {
+    if (steps >= nextClockCheck && !pastDeadline) {
+        nextClockCheck = steps + clockInterval;
+        pastDeadline = std::chrono::steady_clock::now() >= deadline;
+    }
+    return steps >= stepLimit || pastDeadline;
+}
+
+// Process the subsumption queue until it is empty or the work limit has been reached.
+void Preprocessor::subsumeQueued() {
+    while (!subsumptionQueue.empty() && !unsatisfiable && !outOfBudget()) {
+        const std::size_t index = subsumptionQueue.back();
+        subsumptionQueue.pop_back();
+        queued[index] = 0;
+        backwardSubsume(index);
+        propagate();
+    }
+}
+
+// Drop the deleted clauses from the occurrence list of a literal.
+void Preprocessor::cleanOccurrences(Literal literal) {
+    auto & clauses = occurrences[literal];
+    clauses.erase(std::remove_if(clauses.begin(), clauses.end(), [this](std::size_t index) {
+        return clause(index).deleted();
+    }), clauses.end());
+}
+
+// Build the resolvent of two clauses on 'variable'. Returns false if it is a tautology.
+bool Preprocessor::resolve(std::size_t first, std::size_t second, std::uint32_t variable) {
+    ++currentStamp;
+    resolvent.clear();
+    for (Literal literal : clause(first)) {
+        if (variableOf(literal) != variable) {
+            literalStamps[literal] = currentStamp;
+            resolvent.push_back(literal);
+        }
+    }
+    steps += clause(first).size() + clause(second).size();
+    for (Literal literal : clause(second)) {
+        if (variableOf(literal) == variable || literalStamps[literal] == currentStamp)
+            continue;
+        if (literalStamps[negate(literal)] == currentStamp)
+            return false;
+        resolvent.push_back(literal);
+    }
+    return true;
+}
+
+// Eliminate a variable by replacing the clauses containing it with all their resolvents
+// on it, as long as the number of clauses does not grow. The removed clauses are kept
+// on the reconstruction stack.
+void Preprocessor::eliminate(std::uint32_t variable) {
+    if (values[variable] != 0 || eliminated[variable])
+        return;
+
+    const Literal positive = makeLiteral(variable, false);
+    const Literal negative = negate(positive);
+    cleanOccurrences(positive);
+    cleanOccurrences(negative);
+    const std::vector<std::size_t> positives = occurrences[positive];
+    const std::vector<std::size_t> negatives = occurrences[negative];
+    if (!positives.empty() && !negatives.empty() && positives.size() + negatives.size() > occurrenceLimit)
+        return;
+
+    std::vector<std::vector<Literal> > resolvents;
+    for (std::size_t first : positives) {
+        for (std::size_t second : negatives) {
+            if (!resolve(first, second, variable))
+                continue;
+            if (resolvents.size() == positives.size() + negatives.size() || resolvent.size() > resolventLimit)
+                return;
+            resolvents.push_back(resolvent);
+        }
+    }
+
+    for (std::size_t index : positives) {
+        reconstruction.push(positive, clause(index).begin(), clause(index).end());
+        removeClause(index);
+    }
+    for (std::size_t index : negatives) {
+        reconstruction.push(negative, clause(index).begin(), clause(index).end());
+        removeClause(index);
+    }
+    occurrences[positive].clear();
+    occurrences[negative].clear();
+    eliminated[variable] = 1;
+
+    for (auto & literals : resolvents)
+        addClause(literals);
+    propagate();
+    subsumeQueued();
+}
+
+// Remove the deleted clauses from the formula and compact the arena.
+void Preprocessor::compact() {
+    ClauseArena compacted;
+    compacted.reserve(arena.size());
+    auto keep = formula.begin();
+    for (ClauseRef ref : formula) {
+        if (!arena[ref].deleted())
+            *keep++ = arena.relocate(ref, compacted);
+    }
+    formula.erase(keep, formula.end());
+    arena = std::move(compacted);
+}
+
+// Simplify the formula. Variables with few occurrences are eliminated first.
+bool Preprocessor::run(std::vector<Literal> & inputUnits) {
+    for (Literal unit : inputUnits)
+        assign(unit);
+    propagate();
+    subsumeQueued();
+
+    std::vector<std::uint32_t> order;
+    for (std::uint32_t variable = 1; variable <= numberVariables; ++variable)
+        order.push_back(variable);
+    const auto occurrenceCount = [this](std::uint32_t variable) {
+        return occurrences[makeLiteral(variable, false)].size() + occurrences[makeLiteral(variable, true)].size();
+    };
+    std::stable_sort(order.begin(), order.end(), [&occurrenceCount](std::uint32_t a, std::uint32_t b) {
+        return occurrenceCount(a) < occurrenceCount(b);
+    });
+    for (std::uint32_t variable : order) {
+        if (unsatisfiable || outOfBudget())
+            break;
+        eliminate(variable);
+    }
+
+    compact();
+    inputUnits = units;
+    return !unsatisfiable;
+}
@@ -0,0 +1,178 @@
+#ifndef __MAPHPREPROCESS_HPP__
+#define __MAPHPREPROCESS_HPP__
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "maphClause.hpp"
+
+// The clauses removed by variable elimination, which are needed to extend a model of the
+// simplified formula to a model of the original formula.
+class ReconstructionStack {
+
+    // Each clause is stored as its witness literal, its other literals and finally its size.
+    std::vector<Literal> literals;
+
+public:
+
+    // Record a removed clause. The witness is the literal of the eliminated variable.
+    template <typename Iterator>
+    void push(Literal witness, Iterator first, Iterator last) {
+        literals.push_back(witness);
+        std::uint32_t size = 1;
+        for (; first != last; ++first) {
+            if (*first != witness) {
+                literals.push_back(*first);
+                ++size;
+            }
+        }
+        literals.push_back(size);
+    }
+
+    bool empty() const { return literals.empty(); }
+
+    void clear() { literals.clear(); }
+
+    // Extend a model, given as the value of each variable, to the removed clauses. The
+    // clauses are visited in the reverse order of their removal, and the witness of each
+    // clause that is not satisfied is flipped.
+    void extend(std::vector<signed char> & values) const;
+};
+
+// Simplifies a formula before the search in the style of SatELite: bounded variable
+// elimination, forward and backward subsumption and self-subsuming strengthening on
+// occurrence lists.
+class Preprocessor {
+
+    std::size_t numberVariables;
+    ClauseArena & arena;
+
+    // The clauses of the formula. Clauses are identified by their index in this vector.
+    std::vector<ClauseRef> & formula;
+
+    ReconstructionStack & reconstruction;
+
+    bool unsatisfiable;
+
+    // The literals assigned at level 0 and the index of the first one that has not been
+    // propagated yet.
+    std::vector<Literal> units;
+    std::size_t unitHead;
+
+    // The value of each variable indexed by variable: 1 if true, -1 if false and 0 if unassigned.
+    std::vector<signed char> values;
+
+    // Whether each variable has been eliminated, indexed by variable.
+    std::vector<char> eliminated;
+
+    // Maps a literal to the indices of the clauses containing it. Deleted clauses are
+    // removed lazily.
+    std::vector<std::vector<std::size_t> > occurrences;
+
+    // A bit set of the variables of each clause, used to rule out most subsumption checks.
+    std::vector<std::uint64_t> signatures;
+
+    // The clauses that may subsume or strengthen other clauses.
+    std::vector<std::size_t> subsumptionQueue;
+    std::vector<char> queued;
+
+    // Used to test whether a literal occurs in a clause. A literal occurs in the marked
+    // clause if its stamp equals 'currentStamp'.
+    std::vector<std::size_t> literalStamps;
+    std::size_t currentStamp;
+
+    // The resolvent built by 'resolve'.
+    std::vector<Literal> resolvent;
+
+    // The work done so far, counted in visited literals, and the limit on it.
+    std::size_t steps;
+    static constexpr std::size_t stepLimit = 200000000;
+
+    // Preprocessing stops at the deadline. The clock is read once every 'clockInterval' steps.
+    std::chrono::steady_clock::time_point deadline;
+    std::size_t nextClockCheck;
+    bool pastDeadline;
+    static constexpr std::size_t clockInterval = 1000000;
+
+    // Has the work limit or the deadline been reached?
+    bool outOfBudget();
+
+    // Variables with more occurrences, or whose elimination would create longer clauses,
+    // are not eliminated.
+    static constexpr std::size_t occurrenceLimit = 256;
+    static constexpr std::size_t resolventLimit = 20;
+
+    // Returned by 'subsumes' if the first clause neither subsumes nor strengthens the second.
+    static constexpr Literal noSubsumption = ~Literal(0);
+
+    int value(Literal literal) const {
+        const int value = values[variableOf(literal)];
+        return isNegative(literal) ? -value : value;
+    }
+
+    Clause clause(std::size_t index) { return arena[formula[index]]; }
+
+    std::uint64_t computeSignature(std::size_t);
+
+    // Assign a literal at level 0.
+    void assign(Literal);
+
+    // Remove satisfied clauses and falsified literals for the literals assigned at level 0.
+    void propagate();
+
+    // Add a clause to the formula unless a clause of the formula subsumes it, or assign it if
+    // it is a unit clause. The clause may be strengthened first.
+    void addClause(std::vector<Literal> &);
+
+    void removeClause(std::size_t);
+
+    // Remove 'literal' from a clause.
+    void strengthen(std::size_t, Literal literal);
+
+    void enqueue(std::size_t);
+
+    // Does the first clause subsume the second? Returns noLiteral if it does, a literal of the
+    // first clause whose negation can be removed from the second clause if the first clause
+    // subsumes the second after flipping that literal, and noSubsumption otherwise.
+    Literal subsumes(std::size_t, std::size_t);
+
+    // Remove or strengthen the clauses subsumed by a clause.
+    void backwardSubsume(std::size_t);
+
+    // Is a new clause subsumed by a clause of the formula? Removes the literals of the new
+    // clause that self-subsuming strengthening removes.
+    bool forwardSubsumed(std::vector<Literal> &);
+
+    // Process the subsumption queue until it is empty.
+    void subsumeQueued();
+
+    // Drop the deleted clauses from the occurrence list of a literal.
+    void cleanOccurrences(Literal);
+
+    // Build the resolvent of two clauses on 'variable'. Returns false if it is a tautology.
+    bool resolve(std::size_t, std::size_t, std::uint32_t variable);
+
+    // Eliminate a variable by resolution if that does not increase the number of clauses.
+    void eliminate(std::uint32_t);
+
+    // Remove the deleted clauses from the formula and compact the arena.
+    void compact();
+
+public:
+
+    Preprocessor(std::size_t numberVariables, ClauseArena & arena, std::vector<ClauseRef> & formula,
+        ReconstructionStack & reconstruction,
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    // Simplify the formula, which has the unit clauses 'units' besides the clauses in the
+    // arena. Afterwards 'units' holds every literal assigned at level 0. Returns false if the
+    // formula has been found unsatisfiable.
+    bool run(std::vector<Literal> & units);
+
+    // Whether each variable has been eliminated, indexed by variable.
+    const std::vector<char> & eliminatedVariables() const { return eliminated; }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef __MAPHRANDOM_HPP__
+#define __MAPHRANDOM_HPP__
+
+#include <cstdint>
+
+// The xoshiro256** generator (Blackman and Vigna, 2018). It is much faster than the standard
+// Mersenne Twister and keeps 32 bytes of state, so every solver owns one and a seed makes its
+// random choices reproducible. It models a uniform random bit generator, so it can drive the
+// standard distributions as well.
+class RandomGenerator {
+
+    std::uint64_t state[4];
+
+    static std::uint64_t rotate(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+
+    typedef std::uint64_t result_type;
+
+    // The state is filled by SplitMix64 from the seed, which never gives the all-zero state.
+    explicit RandomGenerator(std::uint64_t seed) {
+        for (std::uint64_t & word : state) {
+            seed += 0x9e3779b97f4a7c15;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr std::uint64_t min() { return 0; }
+    static constexpr std::uint64_t max() { return ~std::uint64_t(0); }
+
+    std::uint64_t operator()() {
+        const std::uint64_t result = rotate(state[1] * 5, 7) * 9;
+        const std::uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotate(state[3], 45);
+        return result;
+    }
+
+    // A uniformly distributed number below 'bound', which must not be 0. The high half of the
+    // product of a random number and the bound is unbiased once the products whose low half
+    // falls below 2^64 mod bound are rejected (Lemire, 2019), which is rarely needed.
+    std::uint64_t below(std::uint64_t bound) {
+        unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * bound;
+        if (static_cast<std::uint64_t>(product) < bound) {
+            const std::uint64_t threshold = -bound % bound;
+            while (static_cast<std::uint64_t>(product) < threshold)
+                product = static_cast<unsigned __int128>((*this)()) * bound;
+        }
+        return product >> 64;
+    }
+
+    // A uniformly distributed number in [0, 1) with 53 random bits.
+    double uniform() {
+        return ((*this)() >> 11) * (1.0 / (std::uint64_t(1) << 53));
+    }
+
+    // Reservoir sampling of a single item from a sequence of unknown length: returns true if
+    // the 'count'th item seen should replace the one kept so far, which makes every item
+    // equally likely to be kept at the end.
+    bool chooses(std::uint64_t count) {
+        return below(count) == 0;
+    }
+};
+
+#endif
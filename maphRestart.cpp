@@ -0,0 +1,64 @@
+#include "maphRestart.hpp"
+
+constexpr std::size_t RestartScheduler::lubyUnit;
+constexpr std::size_t RestartScheduler::minimumConflicts;
+constexpr double RestartScheduler::margin;
+constexpr double RestartScheduler::blockingMargin;
+constexpr std::size_t RestartScheduler::blockingConflicts;
+
+// Returns the element with index 'index' of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+// Find the finite subsequence that contains the index and its size, then descend
+// into the subsequence until the index is the last element of one.
+std::size_t RestartScheduler::luby(std::size_t index) {
+    std::size_t size = 1;
+    std::size_t sequence = 0;
+    while (size < index + 1) {
+        ++sequence;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != index) {
+        size = (size - 1) / 2;
+        --sequence;
+        index = index % size;
+    }
+    return std::size_t(1) << sequence;
+}
+
+RestartScheduler::RestartScheduler(Policy policy) :
+    policy(policy), conflicts(0), restarts(0), limit(lubyUnit * luby(0)),
+    fastLBD(1.0 / 32), slowLBD(1.0 / 4096), trailSize(1.0 / 4096), totalConflicts(0) {}
+
+// Record a conflict that led to a learned clause with the given LBD while the trail had the given size.
+void RestartScheduler::conflict(std::size_t lbd, std::size_t trail) {
+    switch (policy) {
+    case Policy::NONE:
+        conflict<Policy::NONE>(lbd, trail);
+        break;
+    case Policy::LUBY:
+        conflict<Policy::LUBY>(lbd, trail);
+        break;
+    case Policy::GLUCOSE:
+        conflict<Policy::GLUCOSE>(lbd, trail);
+        break;
+    }
+}
+
+// Should the solver restart before its next decision?
+bool RestartScheduler::shouldRestart() const {
+    switch (policy) {
+    case Policy::NONE:
+        return shouldRestart<Policy::NONE>();
+    case Policy::LUBY:
+        return shouldRestart<Policy::LUBY>();
+    case Policy::GLUCOSE:
+        return shouldRestart<Policy::GLUCOSE>();
+    }
+    return false;
+}
+
+// Record that the solver has restarted.
+void RestartScheduler::restarted() {
+    conflicts = 0;
+    ++restarts;
+    limit = lubyUnit * luby(restarts);
+}
@@ -0,0 +1,112 @@
+#ifndef __MAPHRESTART_HPP__
+#define __MAPHRESTART_HPP__
+
+#include <cstdlib>
+
+// Decides when the solver should abandon its current decisions and restart from level 0.
+class RestartScheduler {
+
+public:
+
+    enum class Policy {
+        NONE,       // Never restart.
+        LUBY,       // Restart after a number of conflicts that follows the Luby sequence.
+        GLUCOSE     // Restart when recent learned clauses have a higher LBD than the average.
+    };
+
+private:
+
+    // An exponential moving average with bias correction, so that early values are
+    // not dominated by the initial value of zero.
+    class MovingAverage {
+        double biased;
+        double exponent;
+        double alpha;
+        double average;
+    public:
+        explicit MovingAverage(double alpha) : biased(0), exponent(1), alpha(alpha), average(0) {}
+        void update(double value) {
+            biased += alpha * (value - biased);
+            exponent *= 1 - alpha;
+            average = biased / (1 - exponent);
+        }
+        double value() const { return average; }
+    };
+
+    Policy policy;
+
+    std::size_t conflicts;
+    std::size_t restarts;
+
+    // The number of conflicts until the next Luby restart.
+    std::size_t limit;
+
+    // Averages of the LBD of learned clauses over the recent and the whole search,
+    // and of the size of the trail when a conflict occurs.
+    MovingAverage fastLBD;
+    MovingAverage slowLBD;
+    MovingAverage trailSize;
+
+    static constexpr std::size_t lubyUnit = 100;
+    static constexpr std::size_t minimumConflicts = 50;
+    static constexpr double margin = 1.25;
+    static constexpr double blockingMargin = 1.4;
+    static constexpr std::size_t blockingConflicts = 10000;
+
+    std::size_t totalConflicts;
+
+    // Returns the element with index 'index' of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+    static std::size_t luby(std::size_t index);
+
+public:
+
+    explicit RestartScheduler(Policy policy = Policy::NONE);
+
+    // Record a conflict that led to a learned clause with the given LBD while the trail had the given size.
+    void conflict(std::size_t lbd, std::size_t trail);
+
+    // Should the solver restart before its next decision?
+    bool shouldRestart() const;
+
+    // The same for a policy known at compile time, which must be the policy of the scheduler.
+    template <Policy P>
+    void conflict(std::size_t lbd, std::size_t trail);
+    template <Policy P>
+    bool shouldRestart() const;
+
+    // Record that the solver has restarted.
+    void restarted();
+};
+
+template <RestartScheduler::Policy P>
+void RestartScheduler::conflict(std::size_t lbd, std::size_t trail) {
+    ++conflicts;
+    ++totalConflicts;
+    if (P != Policy::GLUCOSE)
+        return;
+
+    fastLBD.update(lbd);
+    slowLBD.update(lbd);
+    trailSize.update(trail);
+
+    // Block the restart if the trail is much larger than usual, as the solver might be
+    // close to a satisfying assignment.
+    if (totalConflicts > blockingConflicts && conflicts >= minimumConflicts &&
+        trail > blockingMargin * trailSize.value())
+        conflicts = 0;
+}
+
+template <RestartScheduler::Policy P>
+bool RestartScheduler::shouldRestart() const {
+    switch (P) {
+    case Policy::NONE:
+        return false;
+    case Policy::LUBY:
+        return conflicts >= limit;
+    case Policy::GLUCOSE:
+        return conflicts >= minimumConflicts && fastLBD.value() > margin * slowLBD.value();
+    }
+    return false;
+}
+
+#endif
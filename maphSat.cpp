@@ -1,572 +1,1232 @@
 // The solver is largely based on the following paper: http://poincare.matf.bg.ac.rs/~filip//phd/sat-tutorial.pdf
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <limits>
-#include <random>
+#include <sstream>
 
+#include <unistd.h>
+
+#include "maphLocal.hpp"
 #include "maphSat.hpp"
 
-// Helper for random selection heuristics.
-// Takes a lower and upper bound and returns a random index within the bounds.
-// It's mainly used for vectors, therefore the upper bound is decremented.
-int getRandomIndex(int lowerBound, int upperBound) {
-    std::random_device randDevice;
-    std::mt19937 rng(randDevice());
-    std::uniform_int_distribution<int> result(lowerBound,upperBound-1);
-    int randIndex = result(rng);
-    return randIndex;
-}
-
-// Helper for computing the combined sum of occurrences (both polarities).
-// If the first parameter is true, it computes the combined sum for the MOMS heuristic
-// and uses the int to determine the 'cutoffLength' of a clause.
-// If false, it computes the usual combined sum for DLCS.
-void MaphSAT::combinedSum(std::vector<std::pair<int, int> > & pos, std::vector<std::pair<int, int> > & neg, bool constraint, std::size_t cutoffLength) const {
-    int counterPos = 0;
-    int counterNeg = 0;
-    for (const auto & clause : formula){
-        for (int literal : clause) {
-            if (constraint && clause.size() > cutoffLength)
-                break;
-            if (std::find_if(trail.begin(), trail.end(), [literal](const auto & p) { return p.first == literal || p.first == -literal; }) == trail.end()) {
-                auto itPos = std::find_if(pos.begin(), pos.end(), [&counterPos, literal](const auto & p) {
-                    counterPos = p.second;
-                    return p.first == literal || p.first == -literal;
-                });
-                auto itNeg = std::find_if(neg.begin(), neg.end(), [&counterNeg, literal](const auto & p) {
-                    counterNeg = p.second;
-                    return p.first == literal || p.first == -literal;
-                });
-
-                if (literal > 0) {
-                    if (itPos == pos.end() && literal > 0)
-                        pos.emplace_back(std::make_pair(literal, 1));
-                    else {
-                        pos.erase(itPos);
-                        const int newPosCounter = ++counterPos;
-                        pos.emplace_back(literal, newPosCounter);
-                    }
-                } else if (literal < 0) {
-                    if (itNeg == neg.end())
-                        neg.emplace_back(literal, 1);
-                    else {
-                        neg.erase(itNeg);
-                        const int newNegCounter = ++counterNeg;
-                        neg.emplace_back(literal, newNegCounter);
-                    }
-                }
-            }
-        }
+constexpr double MaphSAT::activityDecay;
+constexpr std::uint32_t MaphSAT::coreLBD;
+constexpr std::uint32_t MaphSAT::tier2LBD;
+constexpr std::size_t MaphSAT::reductionIncrement;
+constexpr float MaphSAT::clauseActivityDecay;
+constexpr std::size_t MaphSAT::probeBudget;
+constexpr double MaphSAT::equivalenceShare;
+constexpr double MaphSAT::subsumptionShare;
+constexpr double MaphSAT::vivificationShare;
+constexpr std::size_t MaphSAT::exportSize;
+constexpr std::size_t MaphSAT::lookaheadCandidates;
+
+std::atomic<bool> MaphSAT::allInterrupted(false);
+constexpr std::size_t MaphSAT::noBudget;
+constexpr std::size_t MaphSAT::firstInprocessing;
+constexpr std::size_t MaphSAT::firstReduction;
+constexpr std::size_t MaphSAT::localSearchEffort;
+constexpr std::size_t MaphSAT::maximumXorSize;
+
+// Helper for the occurrence-based selection heuristics.
+// Returns the positive literal of the unassigned variable with the highest score. Ties
+// are broken by the smallest variable, or at random if 'Random' is true. The tied variables
+// are sampled as they are found, so they are never collected.
+template <bool Random, typename Score>
+Literal MaphSAT::selectMaxScore(Score score) {
+    std::uint32_t maxVariable = 0;
+    double maxScore = 0;
+    std::uint64_t ties = 0;
+
+    for (std::uint32_t variable = 1; variable <= numberVariables; ++variable) {
+        if (values[variable] != 0)
+            continue;
+        const double variableScore = score(variable);
+        if (maxVariable == 0 || variableScore > maxScore) {
+            maxScore = variableScore;
+            maxVariable = variable;
+            ties = 1;
+        } else if (Random && variableScore == maxScore && generator.chooses(++ties))
+            maxVariable = variable;
     }
+
+    return maxVariable == 0 ? noLiteral : makeLiteral(maxVariable, false);
 }
 
 // Select the first literal that is not yet asserted.
-int MaphSAT::selectFirst() const {
-    for (const auto & clause : formula) {
-        for (int literal : clause) {
-            if (std::find_if(trail.begin(), trail.end(), [literal](const auto & p) { return p.first == literal || p.first == -literal; }) == trail.end())
+Literal MaphSAT::selectFirst() const {
+    for (ClauseRef ref : formula) {
+        for (Literal literal : arena[ref]) {
+            if (value(literal) == 0)
                 return literal;
         }
     }
-    return 0;
+    return noLiteral;
 }
 
 // Selection heuristic: Pick a random literal.
-int MaphSAT::selectRandom() const {
-    int maxLit = 0;
-    std::vector<int> randCandidates;
-
-    for (const auto & clause : formula) {
-        for (int literal : clause) {
-            if (std::find_if(trail.begin(), trail.end(), [literal](const auto & p) { return p.first == literal || p.first == -literal; }) == trail.end())
-                randCandidates.push_back(literal);
+// Each unassigned occurrence of a literal in the formula is equally likely to be picked.
+Literal MaphSAT::selectRandom() {
+    Literal maxLit = noLiteral;
+    std::uint64_t candidates = 0;
+
+    for (ClauseRef ref : formula) {
+        for (Literal literal : arena[ref]) {
+            if (value(literal) == 0 && generator.chooses(++candidates))
+                maxLit = literal;
         }
     }
-    if (!randCandidates.empty()) {
-        const int randIndex = getRandomIndex(0, randCandidates.size());
-        maxLit = randCandidates[randIndex];
-    }
-    if (maxLit > 0)
-        return maxLit;
-    else
-        return -maxLit;
+    return maxLit == noLiteral ? noLiteral : makeLiteral(variableOf(maxLit), false);
 }
 
 // Selection heuristic: Dynamic Largest Individual Sum.
 // Picks the literal with the highest number of occurrences in the unsatisfied clauses.
 // Sets value to true if the literal is positive.
 // If the literal is negative, sets the value of its negation to true.
-// If randomized true, it runs the randomized DLIS variant.
-int MaphSAT::selectDLIS(bool random) const {
-    int counter = 0;
-    int maxNumber = 0;
-    int maxLit = 0;
-    std::vector<int> randCandidates;
-    std::vector<std::pair<int, int> > vCount;
-
-    for (const auto & clause : formula) {
-        for (int literal : clause) {
-            if (std::find_if(trail.begin(), trail.end(),
-                [literal](const auto & p) { return p.first == literal || p.first == -literal; }) == trail.end()) {
-                auto it = std::find_if(vCount.begin(), vCount.end(), [&counter, literal](const auto & p) {
-                    counter = p.second;
-                    return p.first == literal || p.first == -literal;
-                });
-                if (it == vCount.end()) {
-                    vCount.emplace_back(literal, 1);
-                    if (maxNumber > 1) {
-                        maxNumber = 1;
-                        maxLit = literal;
-                    } else if (random && maxNumber == 1)
-                        randCandidates.push_back(literal);
-                } else {
-                    vCount.erase(it);
-                    const int newValue = ++counter;
-                    vCount.emplace_back(literal, newValue);
-                    if (newValue > maxNumber) {
-                        maxNumber = newValue;
-                        maxLit = literal;
-                    } else if (random && newValue == maxNumber)
-                        randCandidates.push_back(literal);
-                }
-            }
+// If 'Random' is true, it runs the randomized DLIS variant.
+template <bool Random>
+Literal MaphSAT::selectDLIS() {
+    return selectMaxScore<Random>([this](std::uint32_t variable) {
+        return std::max(occurrenceCount[makeLiteral(variable, false)], occurrenceCount[makeLiteral(variable, true)]);
+    });
+}
+
+// Selection heuristic: Dynamic Largest Combined Sum.
+// Picks the variable with the highest number of occurrences of its positive and negative literals (combined).
+// If 'Random' is true, it runs the randomized DLCS variant.
+template <bool Random>
+Literal MaphSAT::selectDLCS() {
+    return selectMaxScore<Random>([this](std::uint32_t variable) {
+        return occurrenceCount[makeLiteral(variable, false)] + occurrenceCount[makeLiteral(variable, true)];
+    });
+}
+
+// Selection heuristic: the Jeroslow-Wang method.
+// Picks the literal with the highest sum of 2^-|clause| over the unsatisfied clauses containing it.
+// If 'Random' is true, it runs the randomized J-W variant.
+template <bool Random>
+Literal MaphSAT::selectJW() {
+    return selectMaxScore<Random>([this](std::uint32_t variable) {
+        return std::max(jwWeight[makeLiteral(variable, false)], jwWeight[makeLiteral(variable, true)]);
+    });
+}
+
+// Selection heuristic: Maximum [number of] Occurrences in Minimum [length] Clauses.
+// Only unsatisfied clauses no longer than 'momsCutoff' are counted.
+// If 'Random' is true, it runs the randomized MOMS variant.
+template <bool Random>
+Literal MaphSAT::selectMOMS() {
+    const int parameter = 10; // as suggested in: J. Freeman, “Improvements to propositional satisfiability search algorithms” , PhD thesis, The University of Pennsylvania, 1995.
+    return selectMaxScore<Random>([this, parameter](std::uint32_t variable) {
+        const double pos = shortCount[makeLiteral(variable, false)];
+        const double neg = shortCount[makeLiteral(variable, true)];
+        return (pos + neg) * std::pow(2, parameter) + pos * neg;
+    });
+}
+
+// Select a decision literal with heuristic 'H'. The switch is resolved at compile time.
+template <MaphSAT::Heuristic H>
+Literal MaphSAT::select() {
+    switch (H) {
+    case MaphSAT::Heuristic::FIRST:
+        return selectFirst();
+    case MaphSAT::Heuristic::RANDOM:
+        return selectRandom();
+    case MaphSAT::Heuristic::DLIS:
+        return selectDLIS<false>();
+    case MaphSAT::Heuristic::RDLIS:
+        return selectDLIS<true>();
+    case MaphSAT::Heuristic::DLCS:
+        return selectDLCS<false>();
+    case MaphSAT::Heuristic::RDLCS:
+        return selectDLCS<true>();
+    case MaphSAT::Heuristic::JW:
+        return selectJW<false>();
+    case MaphSAT::Heuristic::RJW:
+        return selectJW<true>();
+    case MaphSAT::Heuristic::MOMS:
+        return selectMOMS<false>();
+    case MaphSAT::Heuristic::RMOMS:
+        return selectMOMS<true>();
+    case MaphSAT::Heuristic::VSIDS:
+        return selectVSIDS();
+    }
+    return noLiteral;
+}
+
+// A policy for heuristic 'H' and restart policy 'R', which propagates XOR constraints if 'Xors'
+// is true and decides pure literals if 'Pure' is true. Every choice is a constant, so the
+// compiler removes the branches not taken.
+template <MaphSAT::Heuristic H, RestartScheduler::Policy R, bool Xors, bool Pure>
+struct MaphSAT::StaticPolicy {
+    // Only the DLIS, DLCS, JW and MOMS heuristics (and their randomized variants) need the
+    // occurrence counters, unless pure literals are decided, and only VSIDS needs the activities.
+    static bool countsOccurrences(const MaphSAT &) {
+        return Pure || (H != MaphSAT::Heuristic::FIRST && H != MaphSAT::Heuristic::RANDOM && H != MaphSAT::Heuristic::VSIDS);
+    }
+    static bool decidesPureLiterals(const MaphSAT &) { return Pure; }
+    static bool ordersByActivity(const MaphSAT &) { return H == MaphSAT::Heuristic::VSIDS; }
+    static bool propagatesXors(const MaphSAT & solver) { return Xors && !solver.gauss.empty(); }
+    static Literal select(MaphSAT & solver) { return solver.select<H>(); }
+    static bool shouldRestart(const RestartScheduler & scheduler) { return scheduler.shouldRestart<R>(); }
+    static void conflict(RestartScheduler & scheduler, std::size_t lbd, std::size_t trail) {
+        scheduler.conflict<R>(lbd, trail);
+    }
+};
+
+// A policy that reads the heuristic and the options of the solver on every call.
+struct MaphSAT::DynamicPolicy {
+    static bool countsOccurrences(const MaphSAT & solver) { return solver.countOccurrences; }
+    static bool decidesPureLiterals(const MaphSAT & solver) { return solver.options.pureLiterals; }
+    static bool ordersByActivity(const MaphSAT & solver) { return solver.heuristic == MaphSAT::Heuristic::VSIDS; }
+    static bool propagatesXors(const MaphSAT & solver) { return !solver.gauss.empty(); }
+    static Literal select(MaphSAT & solver) {
+        switch (solver.heuristic) {
+        case MaphSAT::Heuristic::FIRST:
+            return solver.select<MaphSAT::Heuristic::FIRST>();
+        case MaphSAT::Heuristic::RANDOM:
+            return solver.select<MaphSAT::Heuristic::RANDOM>();
+        case MaphSAT::Heuristic::DLIS:
+            return solver.select<MaphSAT::Heuristic::DLIS>();
+        case MaphSAT::Heuristic::RDLIS:
+            return solver.select<MaphSAT::Heuristic::RDLIS>();
+        case MaphSAT::Heuristic::DLCS:
+            return solver.select<MaphSAT::Heuristic::DLCS>();
+        case MaphSAT::Heuristic::RDLCS:
+            return solver.select<MaphSAT::Heuristic::RDLCS>();
+        case MaphSAT::Heuristic::JW:
+            return solver.select<MaphSAT::Heuristic::JW>();
+        case MaphSAT::Heuristic::RJW:
+            return solver.select<MaphSAT::Heuristic::RJW>();
+        case MaphSAT::Heuristic::MOMS:
+            return solver.select<MaphSAT::Heuristic::MOMS>();
+        case MaphSAT::Heuristic::RMOMS:
+            return solver.select<MaphSAT::Heuristic::RMOMS>();
+        case MaphSAT::Heuristic::VSIDS:
+            return solver.select<MaphSAT::Heuristic::VSIDS>();
         }
+        return noLiteral;
+    }
+    static bool shouldRestart(const RestartScheduler & scheduler) { return scheduler.shouldRestart(); }
+    static void conflict(RestartScheduler & scheduler, std::size_t lbd, std::size_t trail) {
+        scheduler.conflict(lbd, trail);
     }
+};
+
+// Update the occurrence counters of the literals of clause 'clauseIndex' when the
+// clause becomes satisfied (sign -1) or unsatisfied again (sign 1). A literal may become
+// pure when the last occurrence of its negation is satisfied, or when it occurs again
+// while its negation does not.
+template <typename Policy>
+void MaphSAT::updateCounters(std::size_t clauseIndex, int sign) {
+    const auto clause = arena[formula[clauseIndex]];
+    const double weight = std::pow(2.0, -static_cast<double>(clause.size()));
+    const bool isShort = clause.size() <= momsCutoff;
+    for (Literal literal : clause) {
+        occurrenceCount[literal] += sign;
+        jwWeight[literal] += sign * weight;
+        if (isShort)
+            shortCount[literal] += sign;
+        if (Policy::decidesPureLiterals(*this)) {
+            if (sign < 0 && occurrenceCount[literal] == 0 && isPure(negate(literal)))
+                pureCandidates.push_back(negate(literal));
+            else if (sign > 0 && occurrenceCount[literal] == 1 && isPure(literal))
+                pureCandidates.push_back(literal);
+        }
+    }
+}
 
-    if (random && !randCandidates.empty()) {
-        const int randIndex = getRandomIndex(0, randCandidates.size());
-        maxLit = randCandidates[randIndex];
+// Start tracking the occurrences of the literals of clause 'clauseIndex'.
+template <typename Policy>
+void MaphSAT::addOccurrences(std::size_t clauseIndex) {
+    for (Literal literal : arena[formula[clauseIndex]]) {
+        occurrences[literal].push_back(clauseIndex);
+        if (value(literal) == 1)
+            ++trueLiterals[clauseIndex];
     }
-    if (maxLit > 0)
-        return maxLit;
-    else
-        return -maxLit;
+    if (trueLiterals[clauseIndex] == 0)
+        updateCounters<Policy>(clauseIndex, 1);
 }
 
-// Selection heuristic: Dynamic Largest Combined Sum.
-// Picks the variable with the highest number of occurrences of its positive and negative literals (combined).
-// If randomized true, it runs the randomized DLCS variant.
-int MaphSAT::selectDLCS(bool random) const {
-    int counterNeg = 0;
-    int maxScore = 0;
-    int maxLit = 0;
-    std::vector<int> randCandidates;
-    std::vector<std::pair<int, int> > posVariableCount;
-    std::vector<std::pair<int, int> > negVariableCount;
-
-    combinedSum(posVariableCount, negVariableCount, false, 0);
-
-    for (auto & posLit : posVariableCount) {
-        auto itNeg = std::find_if(negVariableCount.begin(), negVariableCount.end(), [&counterNeg, posLit](const auto & negLit) {
-            counterNeg = negLit.second;
-            return negLit.first == -posLit.first;
-        });
-        if (itNeg != negVariableCount.end()) {
-            if (counterNeg + posLit.second > maxScore) {
-                maxScore = counterNeg + posLit.second;
-                maxLit = posLit.first;
-                negVariableCount.erase(itNeg);
-            } else if (random && (counterNeg + posLit.second) == maxScore) {
-                randCandidates.push_back(posLit.first);
-                negVariableCount.erase(itNeg);
-            }
+// Selection heuristic: Variable State Independent Decaying Sum.
+// Picks the unassigned variable with the highest activity, where the activity counts
+// how often a variable took part in recent conflicts.
+Literal MaphSAT::selectVSIDS() {
+    while (!activityHeap.empty()) {
+        const int variable = activityHeap.removeMax();
+        if (values[variable] == 0)
+            return makeLiteral(variable, true);
+    }
+    return noLiteral;
+}
+
+// Increase the activity of the variable of 'literal'.
+void MaphSAT::bumpActivity(Literal literal) {
+    const std::uint32_t variable = variableOf(literal);
+    activityHeap.bump(variable, activityIncrement);
+    // Rescale all activities before they overflow.
+    if (activityHeap.activity(variable) > 1e100) {
+        activityHeap.rescale(1e-100);
+        activityIncrement *= 1e-100;
+    }
+}
+
+// Decay the activities of all variables after a conflict.
+void MaphSAT::decayActivities() {
+    activityIncrement /= activityDecay;
+}
+
+// Pop candidates until an unassigned pure literal is found.
+Literal MaphSAT::nextPureLiteral() {
+    while (!pureCandidates.empty()) {
+        const Literal literal = pureCandidates.back();
+        pureCandidates.pop_back();
+        if (value(literal) == 0 && isPure(literal))
+            return literal;
+    }
+    return noLiteral;
+}
+
+// Assert a literal as a decision literal or as a non-decision literal
+// propagated by the clause 'reason'.
+// The literal is propagated once 'applyUnitPropagate' reaches it in the trail.
+template <typename Policy>
+void MaphSAT::assertLiteral(Literal literal, bool decision, ClauseRef reason) {
+    if (decision) {
+        // A decision literal starts a new decision level.
+        trailLimits.push_back(trail.size());
+        ++numberDecisions;
+    }
+    const std::uint32_t variable = variableOf(literal);
+    values[variable] = isNegative(literal) ? -1 : 1;
+    levels[variable] = decisionLevel();
+    reasons[variable] = reason;
+    trail.push_back(literal);
+    // Clauses that become satisfied no longer count towards the selection heuristics.
+    if (Policy::countsOccurrences(*this)) {
+        for (std::size_t clauseIndex : occurrences[literal]) {
+            if (trueLiterals[clauseIndex]++ == 0)
+                updateCounters<Policy>(clauseIndex, -1);
         }
     }
+}
 
-    if (maxLit == 0) {
-        if (!posVariableCount.empty())
-            maxLit = posVariableCount.front().first;
-        else if (!negVariableCount.empty()) {
-            maxLit = -negVariableCount.front().first;
+// Select a literal that is not yet asserted and assert it as a decision literal.
+template <typename Policy>
+void MaphSAT::applyDecide() {
+    const CycleTimer timer(stats.decideCycles);
+    // The assumptions are decided first. An assumption that is already true gets an empty
+    // decision level, and one that is false refutes the assumptions.
+    while (decisionLevel() < assumptions.size()) {
+        const Literal assumption = substitute(assumptions[decisionLevel()]);
+        if (value(assumption) == -1) {
+            state = MaphSAT::State::UNSAT;
+            assumptionsRefuted = true;
+            analyzeFinal(assumption);
+            return;
         }
+        if (value(assumption) == 0) {
+            assertLiteral<Policy>(assumption, true);
+            return;
+        }
+        trailLimits.push_back(trail.size());
     }
 
-    if (random && !randCandidates.empty()) {
-        const int randIndex = getRandomIndex(0, randCandidates.size());
-        maxLit = randCandidates[randIndex];
+    // A pure literal satisfies clauses without falsifying any, so it is decided first. Deciding it,
+    // rather than asserting it without a reason, keeps conflict analysis sound when learned clauses
+    // later contain its negation.
+    if (Policy::decidesPureLiterals(*this)) {
+        const Literal pure = nextPureLiteral();
+        if (pure != noLiteral) {
+            ++stats.pureLiterals;
+            assertLiteral<Policy>(pure, true);
+            return;
+        }
     }
 
-    return maxLit;
-}
+    Literal literal = Policy::select(*this);
 
-// Selection heuristic: the Jeroslow-Wang method.
-// If randomized true, it runs the randomized J-W variant.
-int MaphSAT::selectJW(bool random) const {
-    double score = 0;
-    double maxScore = std::numeric_limits<double>::min();
-    int maxLit = 0;
-    std::vector<int> randCandidates;
-    std::vector<std::pair<int, double> > JWcount;
-
-    for (const auto & clause : formula) {
-        for (int literal : clause) {
-            if (std::find_if(trail.begin(), trail.end(), [literal](const auto & p) { return p.first == literal || p.first == -literal; }) == trail.end()) {
-                auto it = std::find_if(JWcount.begin(), JWcount.end(), [&score, literal](const auto & p) {
-                    score = p.second;
-                    return p.first == literal || p.first == -literal;
-                });
-                if (it == JWcount.end()) {
-                    double initialScore = std::pow(2.0, -clause.size());
-                    JWcount.emplace_back(literal, initialScore);
-                    if (initialScore > maxScore) {
-                        maxScore = initialScore;
-                        maxLit = literal;
-                    } else if (random && initialScore == maxScore)
-                        randCandidates.push_back(literal);
-                } else {
-                    JWcount.erase(it);
-                    score = score + pow(2.0, -clause.size());
-                    JWcount.emplace_back(literal, score);
-                    if (score > maxScore) {
-                        maxScore = score;
-                        maxLit = literal;
-                    } else if (random && score == maxScore)
-                        randCandidates.push_back(literal);
-                }
+    // The heuristics only consider variables occurring in the formula. Any other
+    // variable still needs an assignment before the formula is satisfied.
+    if (literal == noLiteral) {
+        for (std::uint32_t variable = 1; variable <= numberVariables; ++variable) {
+            if (values[variable] == 0) {
+                literal = makeLiteral(variable, false);
+                break;
             }
         }
+        if (literal == noLiteral)
+            return;
     }
 
-    if (maxLit != 0) {
-        if (random && !randCandidates.empty()) {
-            const int randIndex = getRandomIndex(0, randCandidates.size());
-            maxLit = randCandidates[randIndex];
-        }
-        if (maxLit > 0)
-            return maxLit;
-        else
-            return -maxLit;
+    // Reuse the polarity the variable had when it was last assigned.
+    const bool usePhases = options.phaseSaving || options.localSearch != MaphSAT::LocalSearchMode::NONE;
+    if (usePhases && savedPhases[variableOf(literal)] != 0)
+        literal = makeLiteral(variableOf(literal), savedPhases[variableOf(literal)] < 0);
+
+    assertLiteral<Policy>(literal, true);
+}
+
+// If there are any unit literals due to the current partial evaluation, assert
+// them as non-decision literals. Repeat until there are no more unit literals.
+// The literals in the trail from 'propagationHead' on have not been propagated yet.
+template <typename Policy>
+void MaphSAT::applyUnitPropagate() {
+    while (propagationHead < trail.size() && !conflict) {
+        ++numberPropagations;
+        const Literal literal = trail[propagationHead++];
+        notifyWatches<Policy>(negate(literal));
+        if (!conflict && Policy::propagatesXors(*this))
+            propagateXors<Policy>(literal);
     }
+}
 
-    return 0;
+// Returns the decision level at which 'literal' has been asserted.
+std::size_t MaphSAT::level(Literal literal) const {
+    return levels[variableOf(literal)];
 }
 
-// Selection heuristic: Maximum [number of] Occurrences in Minimum [length] Clauses.
-// If randomized true, it runs the randomized MOMS variant.
-int MaphSAT::selectMOMS(bool random) const {
-    int maxLit = 0;
-    int counterNeg = 0;
-    int maxScore = 0;
-    int parameter = 10; // as suggested in: J. Freeman, “Improvements to propositional satisfiability search algorithms” , PhD thesis, The University of Pennsylvania, 1995.
-    int cutoffLength = 0;
-    std::size_t totalClauseLength = 0;
-    std::vector<int> randCandidates;
-    std::vector<std::pair<int, int> > posVariableCount;
-    std::vector<std::pair<int, int> > negVariableCount;
-
-    for (const auto & clause : formula)
-        totalClauseLength += clause.size();
-
-    cutoffLength = totalClauseLength / formula.size();
-    if (cutoffLength >= 2)
-        --cutoffLength;
-
-    combinedSum(posVariableCount, negVariableCount, true, cutoffLength);
-
-    for (auto & posLit : posVariableCount) {
-        auto itNeg = std::find_if(negVariableCount.begin(), negVariableCount.end(), [&counterNeg, posLit](const auto & negLit) {
-            counterNeg = negLit.second;
-            return negLit.first == -posLit.first;
-        });
-        if (itNeg != negVariableCount.end()) {
-            const int tempScore = (counterNeg + posLit.second) * std::pow(2, parameter) + (counterNeg * posLit.second);
-            if (tempScore > maxScore) {
-                maxScore = tempScore;
-                maxLit = posLit.first;
-                negVariableCount.erase(itNeg);
-            } else if (random && tempScore == maxScore) {
-                randCandidates.push_back(posLit.first);
+// Construct the backjump clause by walking the trail backwards from the conflict.
+// Every marked literal of the current decision level is explained by its reason
+// clause until only one of them, the first UIP, remains.
+template <typename Policy>
+void MaphSAT::applyExplainUIP() {
+    const CycleTimer timer(stats.explainCycles);
+    backjumpClause.clear();
+    // The first slot is reserved for the negation of the first UIP.
+    backjumpClause.push_back(noLiteral);
+
+    // The number of marked literals of the current decision level that have not been explained yet.
+    std::size_t pathCount = 0;
+    Literal literal = noLiteral;
+    ClauseRef reason = conflictClause;
+    std::size_t index = trail.size();
+
+    do {
+        if (arena[reason].learned())
+            bumpClause(reason);
+
+        // Mark the literals of the reason clause, except the literal it propagated.
+        for (Literal lit : arena[reason]) {
+            const std::uint32_t variable = variableOf(lit);
+            if (lit == literal || seen[variable] || level(lit) == 0)
+                continue;
+            seen[variable] = 1;
+            if (Policy::ordersByActivity(*this))
+                bumpActivity(lit);
+            if (level(lit) >= decisionLevel())
+                ++pathCount;
+            else
+                backjumpClause.push_back(lit);
+        }
+
+        // Explain the most recently asserted marked literal next.
+        while (!seen[variableOf(trail[--index])]);
+        literal = trail[index];
+        reason = reasons[variableOf(literal)];
+        seen[variableOf(literal)] = 0;
+        --pathCount;
+    } while (pathCount > 0);
+
+    backjumpClause[0] = negate(literal);
+
+    minimizeBackjumpClause();
+
+    if (Policy::ordersByActivity(*this))
+        decayActivities();
+    clauseActivityIncrement /= clauseActivityDecay;
+}
+
+// Check if a literal of the backjump clause is implied by the other literals of the
+// clause, following reason clauses recursively. 'abstractLevels' is the union of the abstract
+// levels of the clause and lets the search give up early.
+bool MaphSAT::isRedundant(Literal literal, std::uint32_t abstractLevels) {
+    analyzeStack.clear();
+    analyzeStack.push_back(literal);
+    const std::size_t top = analyzeClear.size();
+
+    while (!analyzeStack.empty()) {
+        const Literal current = analyzeStack.back();
+        analyzeStack.pop_back();
+        for (Literal lit : arena[reasons[variableOf(current)]]) {
+            const std::uint32_t variable = variableOf(lit);
+            if (variable == variableOf(current) || seen[variable] || level(lit) == 0)
+                continue;
+            // A decision, or a literal of a level that does not occur in the clause, cannot be removed.
+            if (reasons[variable] == noClause || (abstractLevel(lit) & abstractLevels) == 0) {
+                for (std::size_t i = top; i < analyzeClear.size(); ++i)
+                    seen[variableOf(analyzeClear[i])] = 0;
+                analyzeClear.resize(top);
+                return false;
             }
+            seen[variable] = 1;
+            analyzeStack.push_back(lit);
+            analyzeClear.push_back(lit);
         }
     }
+    return true;
+}
 
-    if (maxLit == 0)
-        maxLit = selectFirst();
-    if (random && !randCandidates.empty()) {
-        const int randIndex = getRandomIndex(0, randCandidates.size());
-        maxLit = randCandidates[randIndex];
+// Remove all redundant literals from the backjump clause.
+void MaphSAT::minimizeBackjumpClause() {
+    analyzeClear.assign(backjumpClause.begin(), backjumpClause.end());
+
+    std::uint32_t abstractLevels = 0;
+    for (std::size_t i = 1; i < backjumpClause.size(); ++i)
+        abstractLevels |= abstractLevel(backjumpClause[i]);
+
+    auto keep = backjumpClause.begin() + 1;
+    for (auto it = backjumpClause.begin() + 1; it != backjumpClause.end(); ++it) {
+        if (reasons[variableOf(*it)] == noClause || !isRedundant(*it, abstractLevels))
+            *keep++ = *it;
     }
+    stats.minimizedLiterals += backjumpClause.end() - keep;
+    backjumpClause.erase(keep, backjumpClause.end());
 
-    return maxLit;
+    for (Literal lit : analyzeClear)
+        seen[variableOf(lit)] = 0;
 }
 
-// Elimiate pure literals.
-void MaphSAT::pureLiteral() {
-    std::vector<int> trackLiterals; // keep track of literals occurring with unique polarity
-    std::vector<int> erasedLiterals; // keep track of the erased literals
-    for (const auto & clause : formula) {
-        for (int literal : clause) {
+// Add a learned clause to the formula to prevent the same conflict from happening again.
+template <typename Policy>
+void MaphSAT::applyLearn() {
+    const CycleTimer timer(stats.learnCycles);
+    // Watch the literal that becomes unit after the backjump, which is the first literal,
+    // and the literal of the backjump level, so that the watches are valid once the backjump is done.
+    if (backjumpClause.size() > 1) {
+        auto highest = std::max_element(backjumpClause.begin() + 1, backjumpClause.end(),
+            [this](Literal lit1, Literal lit2) { return level(lit1) < level(lit2); });
+        std::iter_swap(backjumpClause.begin() + 1, highest);
+    }
 
-            if (std::find_if(trail.begin(), trail.end(), [&](const auto & lit) {
-                return lit.first == literal || lit.first == -literal;
-            }) == trail.end()) {
+    const std::size_t lbd = computeLBD(backjumpClause.begin(), backjumpClause.end());
+    Policy::conflict(restartScheduler, lbd, trail.size());
+    ++stats.learnedClauses;
+    stats.learnedLiterals += backjumpClause.size();
+    stats.learnedLBD += lbd;
 
-                auto it = std::find_if(trackLiterals.begin(), trackLiterals.end(), [&](const auto & lit) {
-                    return lit == -literal;
-                });
-                auto duplicate = std::find_if(trackLiterals.begin(), trackLiterals.end(), [&](const auto & lit) {
-                    return lit == literal;
-                });
-                auto erased = std::find_if(erasedLiterals.begin(), erasedLiterals.end(), [&](const auto & lit) {
-                    return lit == literal || lit == -literal;
-                });
-                if (it == trackLiterals.end() && duplicate == trackLiterals.end() && erased == erasedLiterals.end()) {
-                    trackLiterals.push_back(literal);
-                }
-                else if (it != trackLiterals.end()) {
-                    erasedLiterals.push_back(literal);
-                    trackLiterals.erase(it);
-                }
+    if (exports != nullptr && (backjumpClause.size() <= exportSize || lbd <= coreLBD)) {
+        exports->push(backjumpClause.begin(), backjumpClause.end());
+        ++stats.exportedClauses;
+    }
+
+    formula.push_back(arena.allocate(backjumpClause.begin(), backjumpClause.end(), true));
+    arena[formula.back()].setLBD(lbd);
+    arena[formula.back()].setActivity(clauseActivityIncrement);
+    // Add the clause to the watch list.
+    if (backjumpClause.size() > 1)
+        watchClause(formula.back());
+    if (Policy::countsOccurrences(*this)) {
+        trueLiterals.push_back(0);
+        addOccurrences<Policy>(formula.size() - 1);
+    }
+}
+
+// Remove any literals from the trail that have a decision level greater than 'level'.
+// Only the removed literals are visited.
+template <typename Policy>
+void MaphSAT::removePast(std::size_t level, bool savePhases) {
+    if (decisionLevel() <= level)
+        return;
+    const auto first = trail.begin() + trailLimits[level];
+    for (auto it = first; it != trail.end(); ++it) {
+        const std::uint32_t variable = variableOf(*it);
+        if (savePhases)
+            savedPhases[variable] = values[variable];
+        values[variable] = 0;
+        reasons[variable] = noClause;
+        if (Policy::ordersByActivity(*this))
+            activityHeap.insert(variable);
+        if (Policy::countsOccurrences(*this)) {
+            for (std::size_t clauseIndex : occurrences[*it]) {
+                if (--trueLiterals[clauseIndex] == 0)
+                    updateCounters<Policy>(clauseIndex, 1);
             }
+            // A variable that was pure while it was assigned is pure again once it is unassigned.
+            if (Policy::decidesPureLiterals(*this) && (isPure(*it) || isPure(negate(*it))))
+                pureCandidates.push_back(isPure(*it) ? *it : negate(*it));
         }
     }
-    if (!trackLiterals.empty()) {
-        for (const auto & lit : trackLiterals) {
-            assertLiteral(lit, true);
+    trail.erase(first, trail.end());
+    trailLimits.resize(level);
+    propagationHead = trail.size();
+}
+
+// Returns the literal block distance of a clause, which is the number of
+// distinct decision levels among its literals.
+template <typename Iterator>
+std::size_t MaphSAT::computeLBD(Iterator first, Iterator last) {
+    ++currentStamp;
+    std::size_t lbd = 0;
+    for (auto it = first; it != last; ++it) {
+        const std::size_t lvl = level(*it);
+        if (levelStamps[lvl] != currentStamp) {
+            levelStamps[lvl] = currentStamp;
+            ++lbd;
         }
-        trackLiterals.clear();
     }
+    return lbd;
 }
 
-// Assert a literal as a decision literal or as a non-decision literal.
-void MaphSAT::assertLiteral(int literal, bool decision) {
-    trail.emplace_back(literal, decision);
-    notifyWatches(-literal);
+// Undo all decisions, keeping the literals asserted at level 0.
+template <typename Policy>
+void MaphSAT::restart() {
+    removePast<Policy>(0);
+    restartScheduler.restarted();
+    ++stats.restarts;
 }
 
-// Select a literal that is not yet asserted and assert it as a decision literal.
-void MaphSAT::applyDecide() {
-    int literal = 0;
+// Run all inprocessing techniques, each within its share of the propagations of the search
+// since the last round.
+void MaphSAT::inprocess() {
+    const CycleTimer timer(stats.inprocessCycles);
+    ++stats.inprocessings;
+    const double propagations = numberPropagations - lastInprocessing;
+
+    // Literals asserted at level 0 are never explained, so they need no reasons, and
+    // every clause may be changed.
+    for (Literal lit : trail)
+        reasons[variableOf(lit)] = noClause;
+
+    // The matrix describes the formula before this round. Substitution assigns the replaced
+    // variables false at level 0, which the old rows would propagate as if they were free, so
+    // XORs are not propagated until the matrix is rebuilt at the end. Without the matrix,
+    // propagation does not allocate XOR reasons, which would move the arena under the clause
+    // views of vivification. The recorded reasons are all at level 0 and no longer needed.
+    gauss.clear();
+    xorReasons.clear();
+
+    simplifyLevelZero();
+    if (state == MaphSAT::State::UNKNOWN)
+        substituteEquivalences(equivalenceShare * propagations);
+    if (state == MaphSAT::State::UNKNOWN)
+        subsumeLearned(subsumptionShare * propagations);
+    if (state == MaphSAT::State::UNKNOWN)
+        vivifyLearned(vivificationShare * propagations);
+    if (state == MaphSAT::State::UNKNOWN)
+        simplifyLevelZero();
+    if (options.gaussianElimination && state == MaphSAT::State::UNKNOWN)
+        buildGaussMatrix();
+
+    lastInprocessing = numberPropagations;
+    nextInprocessing = numberConflicts + inprocessingInterval;
+    inprocessingInterval += inprocessingInterval / 2;
+}
 
-    switch (heuristic) {
-    case MaphSAT::Heuristic::FIRST:
-        literal = selectFirst();
-        break;
-    case MaphSAT::Heuristic::RANDOM:
-        literal = selectRandom();
-        break;
-    case MaphSAT::Heuristic::DLIS:
-        literal = selectDLIS(false);
-        break;
-    case MaphSAT::Heuristic::RDLIS:
-        literal = selectDLIS(true);
-        break;
-    case MaphSAT::Heuristic::DLCS:
-        literal = selectDLCS(false);
-        break;
-    case MaphSAT::Heuristic::RDLCS:
-        literal = selectDLCS(true);
-        break;
-    case MaphSAT::Heuristic::JW:
-        literal = selectJW(false);
-        break;
-    case MaphSAT::Heuristic::RJW:
-        literal = selectJW(true);
-        break;
-    case MaphSAT::Heuristic::MOMS:
-        literal = selectMOMS(false);
-        break;
-    case MaphSAT::Heuristic::RMOMS:
-        literal = selectMOMS(true);
-        break;
+// Remove the clauses satisfied at level 0 and the falsified literals of all other clauses,
+// then rebuild the watch lists. Propagation is complete, so no clause becomes unit or empty.
+void MaphSAT::simplifyLevelZero() {
+    for (ClauseRef ref : formula) {
+        const Clause clause = arena[ref];
+        if (clause.deleted())
+            continue;
+        if (std::any_of(clause.begin(), clause.end(), [this](Literal lit) { return value(lit) == 1; })) {
+            clause.markDeleted();
+            continue;
+        }
+        const auto keep = std::remove_if(clause.begin(), clause.end(), [this](Literal lit) { return value(lit) == -1; });
+        clause.shrink(keep - clause.begin());
     }
+    garbageCollect();
+}
 
-    if (literal == 0)
+// Find the strongly connected components of the binary implication graph with Tarjan's
+// algorithm. The literals of a component are equivalent, so each variable of a component
+// is replaced by the variable of its smallest literal. The replaced variables occur in no
+// clause afterwards; they are assigned at level 0 and get their value from the
+// reconstruction stack. A component that contains a literal and its negation makes the
+// formula unsatisfiable.
+void MaphSAT::substituteEquivalences(std::size_t budget) {
+    std::size_t edges = 0;
+    for (const auto & watches : binaryList)
+        edges += watches.size();
+    if (edges == 0 || edges > budget)
         return;
 
-    assertLiteral(literal, true);
-    ++numberDecisions;
+    const std::size_t literals = 2 * numberVariables + 2;
+    std::vector<Literal> representative(literals, noLiteral);
+    std::vector<std::size_t> order(literals, 0);
+    std::vector<std::size_t> lowLink(literals, 0);
+    std::vector<char> onStack(literals, 0);
+    std::vector<Literal> component;
+    // The literals on the depth-first search path and the index of their next edge.
+    std::vector<std::pair<Literal, std::size_t> > path;
+    std::size_t visited = 0;
+
+    // The implication graph has an edge from l to each literal implied by a binary clause once l is true.
+    const auto successor = [this](Literal lit, std::size_t edge) {
+        const Watch & watch = binaryList[negate(lit)][edge];
+        return arena[watch.clause].deleted() || value(watch.blocker) != 0 ? noLiteral : watch.blocker;
+    };
+
+    for (Literal root = 2; root < literals; ++root) {
+        if (order[root] != 0 || value(root) != 0)
+            continue;
+        path.emplace_back(root, 0);
+        order[root] = lowLink[root] = ++visited;
+        component.push_back(root);
+        onStack[root] = 1;
+        while (!path.empty()) {
+            const Literal lit = path.back().first;
+            std::size_t & edge = path.back().second;
+            if (edge < binaryList[negate(lit)].size()) {
+                const Literal next = successor(lit, edge++);
+                if (next == noLiteral)
+                    continue;
+                if (order[next] == 0) {
+                    order[next] = lowLink[next] = ++visited;
+                    component.push_back(next);
+                    onStack[next] = 1;
+                    path.emplace_back(next, 0);
+                } else if (onStack[next]) {
+                    lowLink[lit] = std::min(lowLink[lit], order[next]);
+                }
+                continue;
+            }
+            path.pop_back();
+            if (!path.empty())
+                lowLink[path.back().first] = std::min(lowLink[path.back().first], lowLink[lit]);
+            if (lowLink[lit] != order[lit])
+                continue;
+            // 'lit' is the root of a component, which consists of the literals above it on the stack.
+            const auto first = std::find(component.rbegin(), component.rend(), lit).base() - 1;
+            const Literal smallest = *std::min_element(first, component.end());
+            for (auto it = first; it != component.end(); ++it) {
+                representative[*it] = smallest;
+                onStack[*it] = 0;
+            }
+            for (auto it = first; it != component.end(); ++it) {
+                if (representative[negate(*it)] == smallest) {
+                    state = MaphSAT::State::UNSAT;
+                    return;
+                }
+            }
+            component.erase(first, component.end());
+        }
+    }
+
+    std::vector<std::uint32_t> substituted;
+    for (std::uint32_t variable = 1; variable <= numberVariables; ++variable) {
+        const Literal replacement = representative[makeLiteral(variable, false)];
+        if (replacement != noLiteral && variableOf(replacement) != variable)
+            substituted.push_back(variable);
+    }
+    if (substituted.empty())
+        return;
+
+    // Rewrite every clause with the representatives. 'marks' holds 1 + the sign of each
+    // variable of the rewritten clause, to find duplicate literals and tautologies.
+    std::vector<Literal> units;
+    std::vector<char> marks(numberVariables + 1, 0);
+    for (ClauseRef ref : formula) {
+        const Clause clause = arena[ref];
+        if (clause.deleted())
+            continue;
+        std::uint32_t size = 0;
+        bool tautology = false;
+        for (std::uint32_t i = 0; i < clause.size() && !tautology; ++i) {
+            const Literal lit = representative[clause[i]] == noLiteral ? clause[i] : representative[clause[i]];
+            const char mark = isNegative(lit) ? 2 : 1;
+            if (marks[variableOf(lit)] == 0) {
+                marks[variableOf(lit)] = mark;
+                clause[size++] = lit;
+            } else if (marks[variableOf(lit)] != mark) {
+                tautology = true;
+            }
+        }
+        for (Literal lit : clause)
+            marks[variableOf(lit)] = 0;
+        clause.shrink(size);
+        if (tautology) {
+            clause.markDeleted();
+        } else if (size == 1) {
+            units.push_back(clause[0]);
+            clause.markDeleted();
+        }
+    }
+    garbageCollect();
+
+    // Record each substituted variable x with representative r as the clauses (x | -r) and (-x | r).
+    for (std::uint32_t variable : substituted) {
+        eliminated[variable] = 1;
+        substitutes[variable] = representative[makeLiteral(variable, false)];
+        const Literal lit = makeLiteral(variable, false);
+        const Literal replacement = representative[lit];
+        const Literal implied[] = {lit, negate(replacement)};
+        const Literal implying[] = {negate(lit), replacement};
+        reconstruction.push(lit, std::begin(implied), std::end(implied));
+        reconstruction.push(negate(lit), std::begin(implying), std::end(implying));
+        units.push_back(negate(lit));
+    }
+    assertLevelZero(units);
 }
 
-// If there are any unit literals due to the current partial evaluation, assert
-// them as non-decision literals. Repeat until there are no more unit literals.
-void MaphSAT::applyUnitPropagate() {
-    while (!unitQueue.empty() && !conflict) {
-        const auto literal = unitQueue.back();
-        unitQueue.pop_back();
-        assertLiteral(literal, false);
+// Delete the learned clauses that are subsumed by another learned clause. The clauses are
+// visited from the shortest, and each clause is kept in the list of one of its literals,
+// so that a clause finds every shorter clause subsuming it in the lists of its own literals.
+void MaphSAT::subsumeLearned(std::size_t budget) {
+    std::vector<ClauseRef> learned;
+    for (ClauseRef ref : formula) {
+        if (arena[ref].learned() && !arena[ref].deleted())
+            learned.push_back(ref);
     }
+    std::sort(learned.begin(), learned.end(), [this](ClauseRef ref1, ClauseRef ref2) {
+        return arena[ref1].size() < arena[ref2].size();
+    });
+
+    // Each entry is a clause and a bit set of its variables, to rule out most subset checks.
+    std::vector<std::vector<std::pair<ClauseRef, std::uint64_t> > > lists(2 * numberVariables + 2);
+    std::vector<char> marks(2 * numberVariables + 2, 0);
+    std::size_t steps = 0;
+    bool removed = false;
+    for (ClauseRef ref : learned) {
+        if (steps > budget)
+            break;
+        const Clause clause = arena[ref];
+        std::uint64_t signature = 0;
+        for (Literal lit : clause) {
+            marks[lit] = 1;
+            signature |= std::uint64_t(1) << (variableOf(lit) % 64);
+        }
+
+        ClauseRef subsuming = noClause;
+        for (std::size_t i = 0; i < clause.size() && subsuming == noClause; ++i) {
+            for (const auto & candidate : lists[clause[i]]) {
+                if ((candidate.second & ~signature) != 0)
+                    continue;
+                const auto other = arena[candidate.first];
+                steps += other.size();
+                if (std::all_of(other.begin(), other.end(), [&marks](Literal lit) { return marks[lit]; })) {
+                    subsuming = candidate.first;
+                    break;
+                }
+            }
+        }
+
+        Literal rarest = clause[0];
+        for (Literal lit : clause) {
+            marks[lit] = 0;
+            if (lists[lit].size() < lists[rarest].size())
+                rarest = lit;
+        }
+        steps += clause.size();
+
+        if (subsuming == noClause) {
+            lists[rarest].emplace_back(ref, signature);
+        } else {
+            // The subsuming clause is at least as valuable as the subsumed one.
+            arena[subsuming].setLBD(std::min(arena[subsuming].lbd(), clause.lbd()));
+            clause.markDeleted();
+            removed = true;
+        }
+    }
+    if (removed)
+        garbageCollect();
 }
 
-// Returns the number of decision literals in the trail that precede the first
-// occurrence of 'literal', including 'literal' itself if it is a decision literal.
-std::size_t MaphSAT::level(int literal) const {
-    std::size_t decisions = 0;
-    for (const auto & lit : trail) {
-        if (lit.second)
-            ++decisions;
-        if (lit.first == literal)
+// Shorten learned clauses of the core and tier-2 tiers. The negations of the literals of a
+// clause are asserted one by one as decisions and propagated without the clause itself. If
+// this leads to a conflict, the literals asserted so far form a shorter clause. If a literal
+// becomes true, it and the literals before it do. Falsified literals are dropped. Like
+// probing, vivification counts neither as decisions nor as propagations of the search and
+// leaves the saved phases alone.
+void MaphSAT::vivifyLearned(std::size_t budget) {
+    std::vector<ClauseRef> candidates;
+    for (ClauseRef ref : formula) {
+        const Clause clause = arena[ref];
+        if (clause.learned() && !clause.deleted() && !clause.vivified() && clause.size() > 2 && clause.lbd() <= tier2LBD)
+            candidates.push_back(ref);
+    }
+    // Vivify the most active clauses first.
+    std::sort(candidates.begin(), candidates.end(), [this](ClauseRef ref1, ClauseRef ref2) {
+        return arena[ref1].activity() > arena[ref2].activity();
+    });
+
+    const std::size_t decisions = numberDecisions;
+    const std::size_t start = numberPropagations;
+    std::vector<Literal> original;
+    std::vector<Literal> literals;
+    for (ClauseRef ref : candidates) {
+        if (numberPropagations - start > budget || state != MaphSAT::State::UNKNOWN)
             break;
+        arena[ref].setVivified();
+        // Propagation may allocate XOR reasons, which moves the arena, so the literals are
+        // copied and the clause is looked up again afterwards.
+        original.assign(arena[ref].begin(), arena[ref].end());
+        // Units found by earlier clauses may have satisfied the clause.
+        if (std::any_of(original.begin(), original.end(), [this](Literal lit) { return value(lit) == 1; }))
+            continue;
+
+        unwatchClause(ref);
+        literals.clear();
+        for (Literal lit : original) {
+            const int litValue = value(lit);
+            if (litValue == -1)
+                continue;
+            literals.push_back(lit);
+            if (litValue == 1)
+                break;
+            assertLiteral(negate(lit), true);
+            applyUnitPropagate();
+            if (conflict)
+                break;
+        }
+        conflict = false;
+        removePast(0, false);
+
+        const Clause clause = arena[ref];
+        if (literals.size() == 1) {
+            clause.markDeleted();
+            assertLevelZero(literals);
+            continue;
+        }
+        std::copy(literals.begin(), literals.end(), clause.begin());
+        clause.shrink(literals.size());
+        clause.setLBD(std::min<std::uint32_t>(clause.lbd(), literals.size()));
+        watchClause(ref);
     }
-    return decisions;
+    numberDecisions = decisions;
+    numberPropagations = start;
 }
 
-// Returns a literal from 'clause' that is in the trail such that no other
-// literal from 'clause' comes after it in the trail.
-int MaphSAT::lastAssertedLiteral() const {
-    auto last = std::find_first_of(trail.rbegin(), trail.rend(), backjumpClause.begin(), backjumpClause.end(),
-        [](const auto & lit1, const auto & lit2) { return lit1.first == -lit2; });
-    if (last == trail.rend())
-        return 0;
-    return last->first;
+// Remove a clause from the watch lists of its first two literals.
+void MaphSAT::unwatchClause(ClauseRef ref) {
+    const auto clause = arena[ref];
+    auto & lists = clause.size() == 2 ? binaryList : watchList;
+    for (std::size_t i = 0; i < 2; ++i) {
+        auto & watches = lists[clause[i]];
+        watches.erase(std::find_if(watches.begin(), watches.end(), [ref](const Watch & watch) {
+            return watch.clause == ref;
+        }));
+    }
 }
 
-// Check if the backjump clause satisfies the first UIP condition, which is the
-// case if the backjump clause contains exactly one literal of the current decision level.
-bool MaphSAT::isUIP() const {
-    const int literal = lastAssertedLiteral();
-    for (int lit : backjumpClause) {
-        if (-lit != literal && level(-lit) == level(literal))
-            return false;
+// Assert the literals at level 0 and propagate them.
+void MaphSAT::assertLevelZero(const std::vector<Literal> & units) {
+    for (Literal unit : units) {
+        if (value(unit) == -1)
+            conflict = true;
+        else if (value(unit) == 0)
+            assertLiteral(unit, false);
     }
-    return true;
+    applyUnitPropagate();
+    if (conflict)
+        state = MaphSAT::State::UNSAT;
 }
 
-// Perform a single resolution step between the backjump clause and a clause
-// that is the reason for the propagation of -'literal'.
-void MaphSAT::applyExplain(int literal) {
-    // The index of the clause that forced the propagation of 'literal'.
-    auto it = reason.find(literal);
-    if (it == reason.end())
-        return;
+// Returns the literal that stands for 'literal' in the current formula.
+Literal MaphSAT::substitute(Literal literal) const {
+    while (substitutes[variableOf(literal)] != noLiteral) {
+        const Literal replacement = substitutes[variableOf(literal)];
+        literal = isNegative(literal) ? negate(replacement) : replacement;
+    }
+    return literal;
+}
+
+// Exchange learned clauses with other solvers running in parallel on the same formula.
+void MaphSAT::shareClauses(ClauseBuffer * exportBuffer, const std::vector<const ClauseBuffer *> & importBuffers) {
+    exports = exportBuffer;
+    imports.clear();
+    for (const ClauseBuffer * buffer : importBuffers)
+        imports.emplace_back(buffer, 0);
+}
 
-    // Add the remaining literals from the reason clause to the backjump clauses.
-    for (int lit : formula[it->second]) {
-        if (lit != literal)
-            backjumpClause.push_back(lit);
+// Add the clauses exported by other solvers since the last import as learned clauses.
+// Satisfied clauses are skipped and falsified literals dropped. The clauses of other
+// solvers may contain variables this solver has eliminated, whose values at level 0 are
+// arbitrary, so such clauses are skipped as well.
+void MaphSAT::importClauses() {
+    for (auto & import : imports) {
+        while (state == MaphSAT::State::UNKNOWN && import.first->read(import.second, importedClause)) {
+            bool skip = false;
+            auto keep = importedClause.begin();
+            for (Literal lit : importedClause) {
+                if (eliminated[variableOf(lit)] || value(lit) == 1)
+                    skip = true;
+                else if (value(lit) == 0)
+                    *keep++ = lit;
+            }
+            importedClause.erase(keep, importedClause.end());
+            if (skip)
+                continue;
+
+            ++stats.importedClauses;
+            if (importedClause.size() <= 1) {
+                assertLevelZero(importedClause);
+                if (importedClause.empty())
+                    state = MaphSAT::State::UNSAT;
+                continue;
+            }
+            formula.push_back(arena.allocate(importedClause.begin(), importedClause.end(), true));
+            arena[formula.back()].setLBD(computeLBD(importedClause.begin(), importedClause.end()));
+            arena[formula.back()].setActivity(clauseActivityIncrement);
+            watchClause(formula.back());
+            if (countOccurrences) {
+                trueLiterals.push_back(0);
+                addOccurrences(formula.size() - 1);
+            }
+        }
     }
+}
 
-    backjumpClause.erase(std::remove(backjumpClause.begin(), backjumpClause.end(), literal), backjumpClause.end());
-    backjumpClause.erase(std::remove(backjumpClause.begin(), backjumpClause.end(), -literal), backjumpClause.end());
-    std::sort(backjumpClause.begin(), backjumpClause.end());
-    backjumpClause.erase(std::unique(backjumpClause.begin(), backjumpClause.end()), backjumpClause.end());
+// Increase the activity of a learned clause, mark it as used and update its LBD.
+void MaphSAT::bumpClause(ClauseRef ref) {
+    const Clause clause = arena[ref];
+    clause.setUsed(true);
+    clause.setActivity(clause.activity() + clauseActivityIncrement);
+    // Rescale all activities before they overflow.
+    if (clause.activity() > 1e20f) {
+        for (ClauseRef other : formula) {
+            if (arena[other].learned())
+                arena[other].setActivity(arena[other].activity() * 1e-20f);
+        }
+        clauseActivityIncrement *= 1e-20f;
+    }
+    // The literals of a reason clause are all assigned, so its LBD can be recomputed.
+    if (clause.lbd() > coreLBD) {
+        const std::size_t lbd = computeLBD(clause.begin(), clause.end());
+        if (lbd < clause.lbd())
+            clause.setLBD(lbd);
+    }
 }
 
-// Construct the backjump clause by repeatedly explaining a literal that lead to a
-// conflict until the backjump clause satisfies the first UIP condition.
-void MaphSAT::applyExplainUIP() {
-    while (!isUIP())
-        applyExplain(lastAssertedLiteral());
+// Is the clause the reason for a literal in the trail? The propagated literal of a
+// long clause is its first literal; for a binary clause it can be either literal.
+bool MaphSAT::isLocked(ClauseRef ref) const {
+    const auto clause = arena[ref];
+    for (std::size_t i = 0; i < std::min<std::size_t>(clause.size(), 2); ++i) {
+        if (value(clause[i]) == 1 && reasons[variableOf(clause[i])] == ref)
+            return true;
+    }
+    return false;
 }
 
-// Add a learned clause to the formula to prevent the same conflict from happening again.
-void MaphSAT::applyLearn() {
-    formula.push_back(backjumpClause);
-    // Add the clause to the watch list.
-    watchList[backjumpClause[0]].push_back(formula.size() - 1);
-    watchList[backjumpClause[1]].push_back(formula.size() - 1);
+// Delete learned clauses of low value and compact the clause arena.
+void MaphSAT::reduceDatabase() {
+    const CycleTimer timer(stats.reduceCycles);
+    std::vector<ClauseRef> candidates;
+    for (ClauseRef ref : formula) {
+        const Clause clause = arena[ref];
+        if (!clause.learned() || clause.lbd() <= coreLBD || isLocked(ref))
+            continue;
+        // Tier-2 clauses are only deleted if they have not been used since the last reduction.
+        if (clause.lbd() > tier2LBD || !clause.used())
+            candidates.push_back(ref);
+        clause.setUsed(false);
+    }
+
+    // Delete the half of the candidates with the lowest activity.
+    std::sort(candidates.begin(), candidates.end(), [this](ClauseRef ref1, ClauseRef ref2) {
+        return arena[ref1].activity() < arena[ref2].activity();
+    });
+    for (std::size_t i = 0; i < candidates.size() / 2; ++i)
+        arena[candidates[i]].markDeleted();
+    ++stats.reductions;
+    stats.deletedClauses += candidates.size() / 2;
+
+    garbageCollect();
+
+    reductionInterval += reductionIncrement;
+    nextReduction = numberConflicts + reductionInterval;
 }
 
-// Return an iterator to the first literal in the trail that has a decision level greater than 'level'.
-std::vector<std::pair<int, bool> >::iterator MaphSAT::firstLiteralPast(int level) {
-    int decisions = 0;
-    for (auto it = trail.begin(); it != trail.end(); ++it) {
-        if (it->second)
-            ++decisions;
-        if (decisions > level)
-            return it;
+// Copy the clauses that are not deleted into a new arena, update all references to
+// them and rebuild the watch lists.
+void MaphSAT::garbageCollect() {
+    ClauseArena compacted;
+    compacted.reserve(arena.size());
+
+    // Literals at level 0 are never explained, and inprocessing may delete the clauses that
+    // propagated them as satisfied, so their reasons are dropped rather than relocated.
+    const std::size_t levelZero = trailLimits.empty() ? trail.size() : trailLimits[0];
+    for (std::size_t index = 0; index < levelZero; ++index)
+        reasons[variableOf(trail[index])] = noClause;
+
+    auto keep = formula.begin();
+    for (ClauseRef ref : formula) {
+        if (!arena[ref].deleted())
+            *keep++ = arena.relocate(ref, compacted);
+    }
+    formula.erase(keep, formula.end());
+    formula.shrink_to_fit();
+
+    keep = xorReasons.begin();
+    for (ClauseRef ref : xorReasons) {
+        if (isLocked(ref))
+            *keep++ = arena.relocate(ref, compacted);
+    }
+    xorReasons.erase(keep, xorReasons.end());
+
+    // The reasons above level 0 are locked, so they were not deleted and have been relocated.
+    for (auto it = trail.begin() + levelZero; it != trail.end(); ++it) {
+        ClauseRef & reason = reasons[variableOf(*it)];
+        if (reason != noClause)
+            reason = arena.forward(reason);
+    }
+
+    // The watched literals of each clause are still its first two literals.
+    for (auto & watches : watchList)
+        watches.clear();
+    for (auto & watches : binaryList)
+        watches.clear();
+    arena = std::move(compacted);
+    for (ClauseRef ref : formula) {
+        if (arena[ref].size() > 1)
+            watchClause(ref);
     }
-    return trail.end();
+
+    if (countOccurrences)
+        rebuildOccurrences();
 }
 
-// Remove any literals from the trail that have a decision level greater than 'level'.
-void MaphSAT::removePast(int level) {
-    auto first = firstLiteralPast(level);
-    trail.erase(first, trail.end());
-    numberDecisions = level;
-}
-
-// Return the greatest decision level of the backjump clause exluding 'literal'.
-int MaphSAT::getBackjumpLevel(int literal) {
-    if ((literal != 0 && backjumpClause.size() > 1) ||
-        (literal == 0 && backjumpClause.size() > 0)) {
-        int maxLvl = 0;
-        for (int lit : backjumpClause) {
-            if (-lit != literal) {
-                const int lvl = level(-lit);
-                if (lvl > maxLvl)
-                    maxLvl = lvl;
-            }
+// Recompute the occurrence counters from scratch.
+void MaphSAT::rebuildOccurrences() {
+    for (auto & clauses : occurrences)
+        clauses.clear();
+    std::fill(occurrenceCount.begin(), occurrenceCount.end(), 0);
+    std::fill(jwWeight.begin(), jwWeight.end(), 0.0);
+    std::fill(shortCount.begin(), shortCount.end(), 0);
+    trueLiterals.assign(formula.size(), 0);
+    for (std::size_t clauseIndex = 0; clauseIndex < formula.size(); ++clauseIndex)
+        addOccurrences(clauseIndex);
+
+    // Deleted clauses may have left pure literals that the counters did not see.
+    if (options.pureLiterals) {
+        pureCandidates.clear();
+        for (Literal literal = 2; literal < occurrenceCount.size(); ++literal) {
+            if (value(literal) == 0 && isPure(literal))
+                pureCandidates.push_back(literal);
         }
-        return maxLvl;
-    } else
-        return 0;
+    }
+}
+
+// Return the greatest decision level of the backjump clause exluding its first literal.
+// 'applyLearn' moves a literal of that level to the second position.
+std::size_t MaphSAT::getBackjumpLevel() const {
+    if (backjumpClause.size() > 1)
+        return level(backjumpClause[1]);
+    return 0;
 }
 
 // Backtrack literals from the trail until the backjump clause becomes a unit
 // clause and then assert the unit literal.
+template <typename Policy>
 void MaphSAT::applyBackjump() {
-    const int literal = lastAssertedLiteral();
-    const int level = getBackjumpLevel(literal);
-    removePast(level);
+    const CycleTimer timer(stats.learnCycles);
+    removePast<Policy>(getBackjumpLevel());
 
     conflict = false;
-    unitQueue.clear();
-    unitQueue.push_front(-literal);
-    reason[-literal] = formula.size() - 1;
+    assertLiteral<Policy>(backjumpClause[0], false, formula.back());
 }
 
- // Notify clauses that a literal has been asserted.
-void MaphSAT::notifyWatches(int literal) {
-    // Are there any clauses that watch 'literal'?
-    if (watchList.find(literal) == watchList.end())
-        return;
+// Add a clause to the watch lists of its first two literals.
+void MaphSAT::watchClause(ClauseRef ref) {
+    const auto clause = arena[ref];
+    if (clause.size() == 2) {
+        binaryList[clause[0]].push_back({ref, clause[1]});
+        binaryList[clause[1]].push_back({ref, clause[0]});
+    } else {
+        watchList[clause[0]].push_back({ref, clause[1]});
+        watchList[clause[1]].push_back({ref, clause[0]});
+    }
+}
 
-    std::vector<std::size_t> newWL;
-    newWL.reserve(watchList[literal].size());
+// Notify clauses that a literal has been asserted.
+template <typename Policy>
+void MaphSAT::notifyWatches(Literal literal) {
+    const CycleTimer timer(stats.watchCycles);
+    // Binary clauses imply their other literal directly.
+    for (const Watch & watch : binaryList[literal]) {
+        const int implied = value(watch.blocker);
+        if (implied == 1)
+            continue;
+        if (implied == -1) {
+            conflict = true;
+            conflictClause = watch.clause;
+            return;
+        }
+        assertLiteral<Policy>(watch.blocker, false, watch.clause);
+    }
 
-    const auto list = watchList[literal];
+    // The clauses watching 'literal' are updated in place. Clauses that keep watching
+    // 'literal' are compacted to the front of the list.
+    auto & watches = watchList[literal];
+    auto keep = watches.begin();
 
-    for (std::size_t clauseIndex : list) {
+    for (auto it = watches.begin(); it != watches.end(); ++it) {
 
-        auto & clause = formula[clauseIndex];
+        // Is the clause satisfied by its blocker? Then the clause need not be visited.
+        if (value(it->blocker) == 1) {
+            *keep++ = *it;
+            continue;
+        }
+
+        const ClauseRef ref = it->clause;
+        Clause clause = arena[ref];
         // Swap the watched literals if the first watched literal was falsified.
         if (clause[0] == literal)
             std::swap(clause[0], clause[1]);
 
         // Is the clause already satisfied? Only check the first watched literal.
-        if (std::find_if(trail.begin(), trail.end(), [&clause](const auto & p) { return p.first == clause[0]; }) != trail.end()) {
-            newWL.push_back(clauseIndex);
+        if (clause[0] != it->blocker && value(clause[0]) == 1) {
+            *keep++ = {ref, clause[0]};
             continue;
         }
 
         // Are there any other unfalsified literals in the clause?
-        std::vector<int>::iterator other = clause.end();
-        for (auto it = clause.begin() + 2; it != clause.end(); ++it) {
-            if (std::find_if(trail.begin(), trail.end(), [it](const auto & p) { return p.first == -*it; }) == trail.end()) {
-                other = it;
+        Literal * other = clause.end();
+        for (Literal * lit = clause.begin() + 2; lit != clause.end(); ++lit) {
+            if (value(*lit) != -1) {
+                other = lit;
                 break;
             }
         }
         // If there is, swap the unfalsified literal with the second watched literal.
         if (other != clause.end()) {
-            std::iter_swap(clause.begin() + 1, other);
-            watchList[clause[1]].push_back(clauseIndex);
+            std::swap(clause[1], *other);
+            watchList[clause[1]].push_back({ref, clause[0]});
             continue;
         }
 
         // If there is no other unfalsified literal and the first watched literal is
         // also falsified, then there is a conflict.
-        newWL.push_back(clauseIndex);
-        if (std::find_if(trail.begin(), trail.end(), [&clause](const auto & p) { return p.first == -clause[0]; }) != trail.end()) {
+        *keep++ = {ref, clause[0]};
+        if (value(clause[0]) == -1) {
             conflict = true;
-            backjumpClause.clear();
-            for (int literal : clause)
-                backjumpClause.push_back(literal);
-        } else if (std::find(unitQueue.begin(), unitQueue.end(), clause[0]) == unitQueue.end()) {
-            // If the first watched literal is not falsified, it is a unit literal.
-            unitQueue.push_front(clause[0]);
-            reason[clause[0]] = clauseIndex;
+            conflictClause = ref;
+            // Keep the remaining watches and stop propagating.
+            keep = std::copy(it + 1, watches.end(), keep);
+            break;
         }
+        // If the first watched literal is not falsified, it is a unit literal.
+        assertLiteral<Policy>(clause[0], false, ref);
     }
 
-    watchList[literal] = newWL;
+    watches.erase(keep, watches.end());
 }
 
+MaphSAT::MaphSAT(MaphSAT::Heuristic heuristic, const MaphSAT::Options & options) :
+    heuristic(heuristic), options(options), state(MaphSAT::State::UNKNOWN), numberVariables(0),
+    numberClauses(0), numberDecisions(0), numberConflicts(0), numberPropagations(0), propagationHead(0), conflict(false), conflictClause(noClause),
+    activityIncrement(1.0), restartScheduler(options.restarts), currentStamp(0), assumptionsRefuted(false),
+    searchLoop(selectSearchLoop(heuristic, options)),
+    nextInprocessing(firstInprocessing), inprocessingInterval(firstInprocessing), lastInprocessing(0),
+    gauss(values, levels), nextReduction(firstReduction), reductionInterval(firstReduction), clauseActivityIncrement(1.0f),
+    countOccurrences(options.pureLiterals || (heuristic != MaphSAT::Heuristic::FIRST &&
+        heuristic != MaphSAT::Heuristic::RANDOM && heuristic != MaphSAT::Heuristic::VSIDS)), momsCutoff(0), interrupted(false), limit(MaphSAT::Limit::NONE), nextResourceCheck(0), exports(nullptr), localSearched(false),
+    generator(options.seed), lastProgress(std::chrono::steady_clock::now()), progressConflicts(0), progressPropagations(0) {}
+
 // Parse a CNF formula and throw invalid_argument() if unsuccessful.
 MaphSAT::MaphSAT(std::istream & stream, MaphSAT::Heuristic heuristic) :
-    heuristic(heuristic), state(MaphSAT::State::UNDEF), numberVariables(0),
-    numberClauses(0), numberDecisions(0), conflict(false) {
+    MaphSAT(stream, heuristic, MaphSAT::Options()) {}
+
+MaphSAT::MaphSAT(std::istream & stream, MaphSAT::Heuristic heuristic, const MaphSAT::Options & options) :
+    MaphSAT(heuristic, options) {
     // Skip optional comments and the mandatory 'p cnf' appearing at the top of the CNF formula.
     char c;
     while (stream >> c) {
@@ -585,109 +1245,947 @@ MaphSAT::MaphSAT(std::istream & stream, MaphSAT::Heuristic heuristic) :
     if (!(stream >> numberClauses))
         throw std::invalid_argument("Error parsing DIMACS.");
 
-    // Reserve memory for the clauses and the trail.
-    formula.reserve(numberClauses);
-    trail.reserve(numberVariables);
+    allocate();
 
-    // Parse all clauses.
+    // Parse all clauses. A literal occurs in the current clause if its stamp is the
+    // index of the clause plus one.
     int literal;
-    std::vector<int> clause;
+    std::vector<Literal> clause;
+    std::vector<Literal> units;
+    std::vector<std::size_t> literalStamps(2 * numberVariables + 2, 0);
     for (std::size_t i = 0; i < numberClauses; ++i) {
+        bool tautology = false;
         while (stream >> literal) {
-            if (literal == 0 && clause.size() > 1) {
-                // Add the clause to the formula.
-                formula.push_back(clause);
-                // Add the clause to the watch list.
-                watchList[clause[0]].push_back(formula.size() - 1);
-                watchList[clause[1]].push_back(formula.size() - 1);
+            if (literal == 0) {
+                if (!tautology)
+                    addInputClause(clause, units);
                 clause.clear();
                 break;
-            } else if (literal == 0 && clause.size() == 1) {
-                unitQueue.push_front(clause[0]);
-                clause.clear();
-                break;
-            } else if (literal != 0 && std::find(clause.begin(), clause.end(), literal) == clause.end()) {
-                clause.push_back(literal);
+            } else if (static_cast<std::size_t>(std::abs(literal)) > numberVariables) {
+                throw std::invalid_argument("Error parsing DIMACS.");
+            } else if (literalStamps[negate(toLiteral(literal))] == i + 1) {
+                tautology = true;
+            } else if (literalStamps[toLiteral(literal)] != i + 1) {
+                literalStamps[toLiteral(literal)] = i + 1;
+                clause.push_back(toLiteral(literal));
             }
         }
         if (stream.fail())
             throw std::invalid_argument("Error parsing DIMACS.");
     }
+
+    finishInput(units);
 }
 
-// Solve the CNF formula.
-bool MaphSAT::solve() {
+// Load a CNF formula from a DIMACS parser, which throws invalid_argument() if unsuccessful.
+MaphSAT::MaphSAT(DimacsParser & parser, MaphSAT::Heuristic heuristic, const MaphSAT::Options & options) :
+    MaphSAT(heuristic, options) {
+    read(parser);
+}
+
+// Replace the formula by the one read from a DIMACS parser.
+void MaphSAT::load(DimacsParser & parser) {
+    reset();
+    read(parser);
+}
+
+// Forget the formula and the state of the search. Clearing a vector keeps its memory, so
+// the next formula of a similar size is loaded without growing the tables again.
+void MaphSAT::reset() {
+    state = MaphSAT::State::UNKNOWN;
+    numberVariables = 0;
+    numberClauses = 0;
+    numberDecisions = 0;
+    numberConflicts = 0;
+    numberPropagations = 0;
+    propagationHead = 0;
+    conflict = false;
+    conflictClause = noClause;
+
+    arena.clear();
+    formula.clear();
+    trail.clear();
+    trailLimits.clear();
+    for (auto & watches : watchList)
+        watches.clear();
+    for (auto & watches : binaryList)
+        watches.clear();
+    for (auto & clauses : occurrences)
+        clauses.clear();
+    trueLiterals.clear();
+    pureCandidates.clear();
+    momsCutoff = 0;
+
+    activityIncrement = 1.0;
+    restartScheduler = RestartScheduler(options.restarts);
+    reconstruction.clear();
+    model.clear();
+    assumptions.clear();
+    assumptionsRefuted = false;
+    failedAssumptions.clear();
+    localSearched = false;
+    generator = RandomGenerator(options.seed);
+    gauss.clear();
+    xorReasons.clear();
+    times = PhaseTimes();
+    stats = Statistics();
+    lastProgress = stats.start;
+    progressConflicts = 0;
+    progressPropagations = 0;
+    nextResourceCheck = 0;
+
+    nextInprocessing = firstInprocessing;
+    inprocessingInterval = firstInprocessing;
+    lastInprocessing = 0;
+    nextReduction = firstReduction;
+    reductionInterval = firstReduction;
+    clauseActivityIncrement = 1.0f;
+    interrupted.store(false, std::memory_order_relaxed);
+    limit = MaphSAT::Limit::NONE;
+}
 
-    // Are there any conflicts with the unit literals?
-    for (std::size_t i = 0; i < unitQueue.size(); ++i) {
-        const int unitLiteral = unitQueue[i];
-        if (std::any_of(unitQueue.begin() + i, unitQueue.end(), [unitLiteral](int literal) { return literal == -unitLiteral; })) {
+// Read the formula of a DIMACS parser into an empty solver.
+void MaphSAT::read(DimacsParser & parser) {
+    std::vector<Literal> units;
+    {
+        const ScopedTimer timer(times.parse, options.timePhases);
+        parser.readHeader(numberVariables, numberClauses);
+
+        allocate();
+
+        std::vector<Literal> clause;
+        while (parser.readClause(clause))
+            addInputClause(clause, units);
+    }
+
+    finishInput(units);
+}
+
+// Apply a solver option of the command line.
+bool MaphSAT::Options::parse(const char * const * arguments, int count, int & index) {
+    const char * option = arguments[index];
+    if (std::strcmp(option, "--phase-saving") == 0)
+        phaseSaving = true;
+    else if (std::strcmp(option, "--keep-learned") == 0)
+        reduceDatabase = false;
+    else if (std::strcmp(option, "--preprocess") == 0)
+        preprocess = true;
+    else if (std::strcmp(option, "--inprocess") == 0)
+        inprocess = true;
+    else if (std::strcmp(option, "--gauss") == 0)
+        gaussianElimination = true;
+    else if (std::strcmp(option, "--pure-literals") == 0)
+        pureLiterals = true;
+    else if (std::strcmp(option, "--local-search") == 0 && index + 1 < count) {
+        const char * mode = arguments[++index];
+        if (std::strcmp(mode, "phases") == 0)
+            localSearch = MaphSAT::LocalSearchMode::PHASES;
+        else if (std::strcmp(mode, "only") == 0)
+            localSearch = MaphSAT::LocalSearchMode::ONLY;
+        else
+            return false;
+    } else if (std::strcmp(option, "--restarts") == 0 && index + 1 < count) {
+        const char * policy = arguments[++index];
+        if (std::strcmp(policy, "none") == 0)
+            restarts = RestartScheduler::Policy::NONE;
+        else if (std::strcmp(policy, "luby") == 0)
+            restarts = RestartScheduler::Policy::LUBY;
+        else if (std::strcmp(policy, "glucose") == 0)
+            restarts = RestartScheduler::Policy::GLUCOSE;
+        else
+            return false;
+    } else if (std::strcmp(option, "--conflict-limit") == 0 && index + 1 < count && std::atoll(arguments[index + 1]) > 0)
+        conflictLimit = std::atoll(arguments[++index]);
+    else if (std::strcmp(option, "--propagation-limit") == 0 && index + 1 < count && std::atoll(arguments[index + 1]) > 0)
+        propagationLimit = std::atoll(arguments[++index]);
+    else if (std::strcmp(option, "--seed") == 0 && index + 1 < count) {
+        // Any text but a number would silently give the default seed 0, so it is rejected.
+        const char * text = arguments[++index];
+        char * end = nullptr;
+        errno = 0;
+        seed = std::strtoull(text, &end, 10);
+        if (!std::isdigit(static_cast<unsigned char>(text[0])) || *end != '\0' || errno == ERANGE)
+            return false;
+    }
+    else if (std::strcmp(option, "--time-limit") == 0 && index + 1 < count && std::atof(arguments[index + 1]) > 0)
+        timeLimit = std::atof(arguments[++index]);
+    else if (std::strcmp(option, "--memory-limit") == 0 && index + 1 < count && std::atoll(arguments[index + 1]) > 0)
+        memoryLimit = std::atoll(arguments[++index]);
+    else
+        return false;
+    return true;
+}
+
+// Set up the solver for a formula that has already been parsed.
+MaphSAT::MaphSAT(const Formula & input, MaphSAT::Heuristic heuristic, const MaphSAT::Options & options) :
+    MaphSAT(heuristic, options) {
+    numberVariables = input.numberVariables;
+    numberClauses = input.numberClauses;
+
+    allocate();
+
+    arena = input.arena;
+    formula = input.clauses;
+    if (input.hasEmptyClause)
+        state = MaphSAT::State::UNSAT;
+
+    std::vector<Literal> units = input.units;
+    finishInput(units);
+}
+
+// Size the tables of the solver for 'numberVariables' variables and 'numberClauses' clauses.
+void MaphSAT::allocate() {
+    // Reserve memory for the clauses and the trail. Most input clauses are short, so
+    // assume three literals per clause.
+    formula.reserve(numberClauses);
+    arena.reserve(numberClauses * (Clause::headerSize + 3));
+    trail.reserve(numberVariables);
+
+    // Variables are indexed from 1, so index 0 of the assignment tables is unused.
+    values.assign(numberVariables + 1, 0);
+    levels.assign(numberVariables + 1, 0);
+    reasons.assign(numberVariables + 1, noClause);
+    savedPhases.assign(numberVariables + 1, 0);
+    seen.assign(numberVariables + 1, 0);
+    levelStamps.assign(numberVariables + 1, 0);
+    watchList.resize(2 * numberVariables + 2);
+    binaryList.resize(2 * numberVariables + 2);
+
+    eliminated.assign(numberVariables + 1, 0);
+    substitutes.assign(numberVariables + 1, noLiteral);
+
+    if (heuristic == MaphSAT::Heuristic::VSIDS) {
+        activityHeap = VariableHeap(numberVariables);
+        for (std::size_t variable = 1; variable <= numberVariables; ++variable)
+            activityHeap.insert(variable);
+    }
+
+    // A seed gives each variable a small random initial activity and a random initial phase,
+    // so that solvers with different seeds search differently.
+    if (options.seed != 0) {
+        for (std::size_t variable = 1; variable <= numberVariables; ++variable) {
+            if (heuristic == MaphSAT::Heuristic::VSIDS)
+                activityHeap.bump(variable, 1e-3 * generator.uniform());
+            savedPhases[variable] = generator() & 1 ? 1 : -1;
+        }
+    }
+}
+
+// Add a clause of the input formula. Unit clauses are collected in 'units' and asserted
+// once the solver is set up.
+void MaphSAT::addInputClause(const std::vector<Literal> & clause, std::vector<Literal> & units) {
+    if (clause.empty()) {
+        // The empty clause can never be satisfied.
+        state = MaphSAT::State::UNSAT;
+    } else if (clause.size() == 1) {
+        units.push_back(clause[0]);
+    } else {
+        // Add the clause to the formula. It is watched by 'finishInput'.
+        formula.push_back(arena.allocate(clause.begin(), clause.end(), false));
+    }
+}
+
+// Preprocess the input formula if enabled, watch the clauses, set up the occurrence
+// counters and assert the unit clauses.
+void MaphSAT::finishInput(std::vector<Literal> & units) {
+    const ScopedTimer timer(times.preprocess, options.timePhases);
+
+    // Eliminated variables occur in no clause, so they are assigned false at level 0 to keep them
+    // out of the search. Their values in the model come from the reconstruction stack.
+    // Preprocessing is skipped if a limit has run out while reading, and stops when the time
+    // runs out. The search reports the limit.
+    if (options.preprocess && state == MaphSAT::State::UNKNOWN && !checkLimits(true)) {
+        auto deadline = std::chrono::steady_clock::time_point::max();
+        if (options.timeLimit > 0)
+            deadline = stats.start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(options.timeLimit));
+        Preprocessor preprocessor(numberVariables, arena, formula, reconstruction, deadline);
+        if (!preprocessor.run(units))
             state = MaphSAT::State::UNSAT;
+        eliminated = preprocessor.eliminatedVariables();
+    }
+
+    // Size each watch list before filling it, so that the lists are not grown one clause at a time.
+    std::vector<std::uint32_t> binaryWatches(2 * numberVariables + 2, 0);
+    std::vector<std::uint32_t> longWatches(2 * numberVariables + 2, 0);
+    for (ClauseRef ref : formula) {
+        const auto clause = arena[ref];
+        auto & watches = clause.size() == 2 ? binaryWatches : longWatches;
+        ++watches[clause[0]];
+        ++watches[clause[1]];
+    }
+    for (std::size_t literal = 0; literal < watchList.size(); ++literal) {
+        binaryList[literal].reserve(binaryWatches[literal]);
+        watchList[literal].reserve(longWatches[literal]);
+    }
+    for (ClauseRef ref : formula)
+        watchClause(ref);
+
+    if (countOccurrences) {
+        // MOMS only counts clauses that are shorter than the average clause of the input formula.
+        std::size_t totalClauseLength = 0;
+        for (ClauseRef ref : formula)
+            totalClauseLength += arena[ref].size();
+        momsCutoff = formula.empty() ? 0 : totalClauseLength / formula.size();
+        if (momsCutoff >= 2)
+            --momsCutoff;
+
+        occurrences.resize(2 * numberVariables + 2);
+        occurrenceCount.assign(2 * numberVariables + 2, 0);
+        jwWeight.assign(2 * numberVariables + 2, 0.0);
+        shortCount.assign(2 * numberVariables + 2, 0);
+        rebuildOccurrences();
+    }
+
+    // Assert the unit clauses at level 0. Two contradicting unit clauses make the formula unsatisfiable.
+    for (Literal unit : units) {
+        if (value(unit) == -1)
+            state = MaphSAT::State::UNSAT;
+        else if (value(unit) == 0)
+            assertLiteral(unit, false);
+    }
+    for (std::uint32_t variable = 1; variable < eliminated.size(); ++variable) {
+        if (eliminated[variable])
+            assertLiteral(makeLiteral(variable, true), false);
+    }
+
+    if (options.preprocess && state == MaphSAT::State::UNKNOWN)
+        probeFailedLiterals();
+    if (options.gaussianElimination && state == MaphSAT::State::UNKNOWN)
+        buildGaussMatrix();
+}
+
+// Probe both literals of each variable that imply another literal by a binary clause.
+// Probing asserts the literal as a decision and propagates it. Probing is not part of the
+// search: it counts neither as decisions nor as propagations, so the limits ignore it, and
+// it leaves the saved phases alone.
+void MaphSAT::probeFailedLiterals() {
+    applyUnitPropagate();
+    const std::size_t decisions = numberDecisions;
+    const std::size_t searchPropagations = numberPropagations;
+    std::size_t propagations = 0;
+    for (std::uint32_t variable = 1; variable <= numberVariables && propagations < probeBudget; ++variable) {
+        // Probing a large formula may take long enough for the time or the memory to run out.
+        if (variable % probeCheck == 0 && checkLimits(true))
+            break;
+        for (bool negative : {false, true}) {
+            const Literal literal = makeLiteral(variable, negative);
+            if (conflict || values[variable] != 0 || binaryList[negate(literal)].empty())
+                continue;
+            const std::size_t trailSize = trail.size();
+            assertLiteral(literal, true);
+            applyUnitPropagate();
+            propagations += trail.size() - trailSize;
+            const bool failed = conflict;
+            conflict = false;
+            removePast(0, false);
+            if (failed) {
+                assertLiteral(negate(literal), false);
+                applyUnitPropagate();
+            }
+        }
+    }
+    numberDecisions = decisions;
+    numberPropagations = searchPropagations;
+
+    if (conflict)
+        state = MaphSAT::State::UNSAT;
+}
+
+// Select the literal to split a cube on by lookahead. The candidates are the free variables
+// that the selection heuristic rates highest: the product of the Jeroslow-Wang weights of
+// both literals if the occurrence counters are maintained, the VSIDS activity otherwise.
+// Each candidate is scored by the product of the numbers of literals its two branches
+// assign, which favours variables that shrink the formula in both branches.
+bool MaphSAT::lookahead(std::vector<Literal> & cube, Literal & split) {
+    split = noLiteral;
+    removePast(0);
+    applyUnitPropagate();
+    if (conflict)
+        state = MaphSAT::State::UNSAT;
+    if (state == MaphSAT::State::UNSAT)
         return false;
+
+    const std::size_t decisions = numberDecisions;
+    bool refuted = false;
+    const auto assertCube = [this, &refuted](Literal literal) {
+        literal = substitute(literal);
+        if (value(literal) == 0) {
+            assertLiteral(literal, true);
+            applyUnitPropagate();
+        }
+        refuted = conflict || value(literal) == -1;
+    };
+    for (std::size_t i = 0; i < cube.size() && !refuted; ++i)
+        assertCube(cube[i]);
+
+    std::vector<std::pair<double, std::uint32_t> > candidates;
+    for (std::uint32_t variable = 1; variable <= numberVariables && !refuted; ++variable) {
+        if (values[variable] != 0 || eliminated[variable])
+            continue;
+        const double score = countOccurrences ?
+            jwWeight[makeLiteral(variable, false)] * jwWeight[makeLiteral(variable, true)] :
+            heuristic == MaphSAT::Heuristic::VSIDS ? activityHeap.activity(variable) : 0.0;
+        candidates.emplace_back(score, variable);
+    }
+    const std::size_t number = std::min(candidates.size(), lookaheadCandidates);
+    std::partial_sort(candidates.begin(), candidates.begin() + number, candidates.end(),
+        [](const std::pair<double, std::uint32_t> & a, const std::pair<double, std::uint32_t> & b) {
+            return a.first > b.first;
+        });
+
+    double bestScore = -1;
+    for (std::size_t i = 0; i < number && !refuted; ++i) {
+        const std::uint32_t variable = candidates[i].second;
+        if (values[variable] != 0)
+            continue;
+        const std::size_t base = decisionLevel();
+        std::size_t assigned[2];
+        bool failed[2];
+        for (bool negative : {false, true}) {
+            const std::size_t trailSize = trail.size();
+            assertLiteral(makeLiteral(variable, negative), true);
+            applyUnitPropagate();
+            assigned[negative] = trail.size() - trailSize;
+            failed[negative] = conflict;
+            conflict = false;
+            removePast(base);
+        }
+
+        if (failed[0] || failed[1]) {
+            // The other branch is implied by the cube.
+            const Literal implied = makeLiteral(variable, failed[0]);
+            cube.push_back(implied);
+            refuted = failed[0] && failed[1];
+            if (!refuted)
+                assertCube(implied);
+            continue;
+        }
+        const double score = static_cast<double>(assigned[0]) * assigned[1];
+        if (score > bestScore) {
+            bestScore = score;
+            // Branch first into the side that assigns more literals.
+            split = makeLiteral(variable, assigned[1] > assigned[0]);
+        }
+    }
+
+    // A failed literal may have assigned the variable chosen before it.
+    if (split != noLiteral && values[variableOf(split)] != 0)
+        split = noLiteral;
+    if (!refuted && split == noLiteral) {
+        for (std::uint32_t variable = 1; variable <= numberVariables && split == noLiteral; ++variable) {
+            if (values[variable] == 0 && !eliminated[variable])
+                split = makeLiteral(variable, false);
+        }
+    }
+
+    conflict = false;
+    removePast(0);
+    numberDecisions = decisions;
+    return !refuted;
+}
+
+// Collect the assumptions the falsified assumption 'literal' depends on. The literals assigned
+// above level 0 without a reason are exactly the decided assumptions.
+void MaphSAT::analyzeFinal(Literal literal) {
+    failedAssumptions.assign(1, literal);
+    if (decisionLevel() == 0)
+        return;
+    seen[variableOf(literal)] = 1;
+    for (std::size_t index = trail.size(); index-- > trailLimits[0];) {
+        const std::uint32_t variable = variableOf(trail[index]);
+        if (!seen[variable])
+            continue;
+        seen[variable] = 0;
+        if (reasons[variable] == noClause) {
+            failedAssumptions.push_back(trail[index]);
+            continue;
         }
+        for (Literal lit : arena[reasons[variable]]) {
+            if (variableOf(lit) != variable && level(lit) > 0)
+                seen[variableOf(lit)] = 1;
+        }
+    }
+    seen[variableOf(literal)] = 0;
+}
+
+// The units implied by the XOR constraints are asserted at level 0 without a reason.
+void MaphSAT::buildGaussMatrix() {
+    std::vector<Literal> units;
+    if (!gauss.build(numberVariables, detectXors(arena, formula, maximumXorSize), units)) {
+        state = MaphSAT::State::UNSAT;
+        return;
+    }
+    for (Literal unit : units)
+        assertLiteral(unit, false);
+}
+
+template <typename Policy>
+void MaphSAT::propagateXors(Literal literal) {
+    const CycleTimer timer(stats.xorCycles);
+    const bool consistent = gauss.assign(variableOf(literal));
+    for (std::size_t i = 0; i < gauss.numberClauses(); ++i) {
+        xorReasons.push_back(arena.allocate(gauss.clauseBegin(i), gauss.clauseEnd(i), false));
+        if (!consistent && i + 1 == gauss.numberClauses()) {
+            conflict = true;
+            conflictClause = xorReasons.back();
+        } else {
+            assertLiteral<Policy>(*gauss.clauseBegin(i), false, xorReasons.back());
+        }
+    }
+}
+
+// Local search works on the clauses that are not learned and keeps the variables assigned at
+// level 0 fixed. A model it finds is confirmed by the search without a conflict: every decision
+// follows the saved phases, and a clause satisfied by the model can only propagate a literal
+// of the model.
+void MaphSAT::localSearch() {
+    LocalSearch sls(numberVariables, arena, formula, values, generator);
+    sls.initialize(savedPhases);
+    const std::size_t flips = localSearchEffort * (formula.size() + 1);
+    bool found = sls.run(flips);
+    while (!found && options.localSearch == MaphSAT::LocalSearchMode::ONLY) {
+        if (isInterrupted() || checkLimits(true))
+            return;
+        found = sls.run(flips);
+    }
+
+    const std::vector<char> & best = sls.bestAssignment();
+    for (std::size_t variable = 1; variable <= numberVariables; ++variable) {
+        if (values[variable] == 0)
+            savedPhases[variable] = best[variable] ? 1 : -1;
+    }
+    localSearched = true;
+}
+
+// Make room for the variables up to 'variables'. New variables start unassigned with no
+// activity and no saved phase.
+void MaphSAT::growVariables(std::size_t variables) {
+    if (variables <= numberVariables)
+        return;
+    const std::size_t first = numberVariables + 1;
+    numberVariables = variables;
+
+    values.resize(numberVariables + 1, 0);
+    levels.resize(numberVariables + 1, 0);
+    reasons.resize(numberVariables + 1, noClause);
+    savedPhases.resize(numberVariables + 1, 0);
+    seen.resize(numberVariables + 1, 0);
+    if (levelStamps.size() < numberVariables + 1)
+        levelStamps.resize(numberVariables + 1, 0);
+    watchList.resize(2 * numberVariables + 2);
+    binaryList.resize(2 * numberVariables + 2);
+    eliminated.resize(numberVariables + 1, 0);
+    substitutes.resize(numberVariables + 1, noLiteral);
+
+    if (heuristic == MaphSAT::Heuristic::VSIDS) {
+        activityHeap.grow(numberVariables);
+        for (std::size_t variable = first; variable <= numberVariables; ++variable)
+            activityHeap.insert(variable);
     }
+    if (countOccurrences) {
+        occurrences.resize(2 * numberVariables + 2);
+        occurrenceCount.resize(2 * numberVariables + 2, 0);
+        jwWeight.resize(2 * numberVariables + 2, 0.0);
+        shortCount.resize(2 * numberVariables + 2, 0);
+    }
+}
+
+// Convert a DIMACS literal given by the user. Substituted variables are replaced by their
+// representatives, but the clauses of variables eliminated by preprocessing are gone.
+Literal MaphSAT::userLiteral(int literal) {
+    if (literal == 0 || literal == std::numeric_limits<int>::min())
+        throw std::invalid_argument("Invalid literal.");
+    growVariables(std::abs(literal));
+    const Literal lit = substitute(toLiteral(literal));
+    if (eliminated[variableOf(lit)])
+        throw std::invalid_argument("Literal of an eliminated variable.");
+    return lit;
+}
+
+// Add a clause at level 0. Literals false at level 0 are dropped, and clauses that are
+// satisfied at level 0 or tautologies are not added at all.
+bool MaphSAT::addClause(const std::vector<int> & clause) {
+    if (state == MaphSAT::State::UNSAT && !assumptionsRefuted)
+        return false;
+    addedClause.clear();
+    for (int literal : clause)
+        addedClause.push_back(userLiteral(literal));
+
+    // The answer of the last call no longer holds for the extended formula.
+    removePast(0);
+    state = MaphSAT::State::UNKNOWN;
+    assumptionsRefuted = false;
+    localSearched = false;
+    ++numberClauses;
+
+    // A literal and its negation are adjacent once the literals are sorted.
+    std::sort(addedClause.begin(), addedClause.end());
+    addedClause.erase(std::unique(addedClause.begin(), addedClause.end()), addedClause.end());
+    auto keep = addedClause.begin();
+    for (auto it = addedClause.begin(); it != addedClause.end(); ++it) {
+        if (value(*it) == 1 || (it + 1 != addedClause.end() && *(it + 1) == negate(*it)))
+            return true;
+        if (value(*it) == 0)
+            *keep++ = *it;
+    }
+    addedClause.erase(keep, addedClause.end());
+
+    if (addedClause.size() <= 1) {
+        if (addedClause.empty())
+            state = MaphSAT::State::UNSAT;
+        else
+            assertLevelZero(addedClause);
+        return state != MaphSAT::State::UNSAT;
+    }
+    formula.push_back(arena.allocate(addedClause.begin(), addedClause.end(), false));
+    watchClause(formula.back());
+    if (countOccurrences) {
+        trueLiterals.push_back(0);
+        addOccurrences(formula.size() - 1);
+    }
+    return true;
+}
 
-    // Until the formula is satisfiable or unsatisfiable, the state of the solver is undefined.
-    while (state == MaphSAT::State::UNDEF) {
+// Solve the CNF formula.
+bool MaphSAT::solve() {
+    assumptions.clear();
+    return search(noBudget);
+}
+
+// Solve the CNF formula under assumptions given as DIMACS literals.
+bool MaphSAT::solve(const std::vector<int> & literals) {
+    assumptions.clear();
+    for (int literal : literals)
+        assumptions.push_back(userLiteral(literal));
+    return search(noBudget);
+}
+
+// Solve the CNF formula under the assumptions of a cube within a budget of conflicts.
+bool MaphSAT::solve(const std::vector<Literal> & cube, std::size_t conflictBudget) {
+    assumptions = cube;
+    return search(conflictBudget);
+}
+
+// The value of a DIMACS literal in the model found by the last call to 'solve'.
+bool MaphSAT::modelValue(int literal) const {
+    const std::size_t variable = std::abs(literal);
+    if (variable >= model.size())
+        return false;
+    return literal > 0 ? model[variable] > 0 : model[variable] < 0;
+}
+
+// Is the DIMACS literal one of the failed assumptions of the last call to 'solve'?
+bool MaphSAT::failed(int assumption) const {
+    if (!assumptionsRefuted || assumption == 0 || static_cast<std::size_t>(std::abs(assumption)) > numberVariables)
+        return false;
+    const Literal literal = substitute(toLiteral(assumption));
+    return std::find(failedAssumptions.begin(), failedAssumptions.end(), literal) != failedAssumptions.end();
+}
+
+// Search under the assumptions. Only a conflict at level 0 makes the formula unsatisfiable for
+// good, so the answer of an earlier call is discarded.
+template <typename Policy>
+bool MaphSAT::searchWith(std::size_t conflictBudget) {
+    if (state == MaphSAT::State::SAT || assumptionsRefuted)
+        state = MaphSAT::State::UNKNOWN;
+    assumptionsRefuted = false;
+    removePast<Policy>(0);
+    // Every assumption may get a decision level of its own.
+    if (levelStamps.size() < numberVariables + assumptions.size() + 1)
+        levelStamps.resize(numberVariables + assumptions.size() + 1, 0);
+    const std::size_t conflictLimit =
+        conflictBudget == noBudget ? noBudget : numberConflicts + conflictBudget;
+    limit = MaphSAT::Limit::NONE;
+    checkLimits(true);
+
+    if (options.localSearch != MaphSAT::LocalSearchMode::NONE && !localSearched && state == MaphSAT::State::UNKNOWN) {
+        applyUnitPropagate<Policy>();
+        if (!conflict)
+            localSearch();
+    }
+
+    // Until the formula is satisfiable or unsatisfiable, the state of the solver is unknown.
+    while (state == MaphSAT::State::UNKNOWN && numberConflicts < conflictLimit && !isInterrupted() &&
+           !checkLimits(false)) {
         // Assert any unit literals.
-        applyUnitPropagate();
-        // Eliminate pure literals. It slowed out solver down so we uncommented it.
-        // pureLiteral();
+        {
+            const ScopedTimer timer(times.propagate, options.timePhases);
+            applyUnitPropagate<Policy>();
+        }
         // Do the current assignments lead to a conflict?
         if (conflict) {
             // Can we backtrack to resolve the conflict?
-            if (numberDecisions == 0)
+            if (decisionLevel() == 0)
                 state = MaphSAT::State::UNSAT;
             else {
-                applyExplainUIP();
-                applyLearn();
-                applyBackjump();
+                ++numberConflicts;
+                const ScopedTimer timer(times.analyze, options.timePhases);
+                applyExplainUIP<Policy>();
+                applyLearn<Policy>();
+                applyBackjump<Policy>();
+                if (numberConflicts % progressCheck == 0) {
+                    if (options.progress)
+                        printProgress();
+                    checkLimits(true);
+                }
             }
         } else {
             // Does every variable have an assignment? If that is the case, we are done.
             // Otherwise assign a value to a variable that has no assignment yet.
-            if (trail.size() == numberVariables)
+            if (trail.size() == numberVariables && decisionLevel() >= assumptions.size())
                 state = MaphSAT::State::SAT;
-            else
-                applyDecide();
+            else {
+                // Propagation is complete, so this is a safe point to restart.
+                if (decisionLevel() > 0 && Policy::shouldRestart(restartScheduler))
+                    restart<Policy>();
+                // Inprocessing works at level 0, so it undoes all decisions first.
+                if (options.inprocess && numberConflicts >= nextInprocessing) {
+                    removePast<Policy>(0);
+                    inprocess();
+                    continue;
+                }
+                if (options.reduceDatabase && numberConflicts >= nextReduction)
+                    reduceDatabase();
+                // The reasons recorded by the matrix are collected once they outnumber the clauses.
+                else if (xorReasons.size() > formula.size())
+                    garbageCollect();
+                // Imported unit clauses need to be propagated before the next decision.
+                if (decisionLevel() == 0 && !imports.empty()) {
+                    const std::size_t trailSize = trail.size();
+                    importClauses();
+                    if (trail.size() != trailSize || state != MaphSAT::State::UNKNOWN)
+                        continue;
+                }
+                const ScopedTimer timer(times.decide, options.timePhases);
+                applyDecide<Policy>();
+            }
         }
     }
 
-    // If the formula is satisfiable, the trail represents the satisfying assignment.
-    // Sort the trail before it gets printed.
+    // If the formula is satisfiable, the trail represents the satisfying assignment. Extend it to
+    // the variables eliminated by preprocessing.
     if (state == MaphSAT::State::SAT) {
-        std::sort(trail.begin(), trail.end(), [](const auto & l1, const auto & l2) {
-            const int abs1 = std::abs(l1.first);
-            const int abs2 = std::abs(l2.first);
-            return abs1 < abs2;
-        });
+        model = values;
+        reconstruction.extend(model);
         return true;
     }
 
+    if (state == MaphSAT::State::UNKNOWN && limit == MaphSAT::Limit::NONE && isInterrupted())
+        limit = MaphSAT::Limit::INTERRUPTED;
     return false;
 }
 
+// Choose the search loop specialized for the heuristic, the restart policy, whether XOR
+// constraints are propagated and whether pure literals are decided, one template parameter
+// at a time.
+MaphSAT::SearchLoop MaphSAT::selectSearchLoop(MaphSAT::Heuristic heuristic, const MaphSAT::Options & options) {
+#ifdef MAPH_GENERIC
+    (void)heuristic;
+    (void)options;
+    return &MaphSAT::searchWith<DynamicPolicy>;
+#else
+    switch (heuristic) {
+    case MaphSAT::Heuristic::FIRST:
+        return selectSearchLoop<MaphSAT::Heuristic::FIRST>(options);
+    case MaphSAT::Heuristic::RANDOM:
+        return selectSearchLoop<MaphSAT::Heuristic::RANDOM>(options);
+    case MaphSAT::Heuristic::DLIS:
+        return selectSearchLoop<MaphSAT::Heuristic::DLIS>(options);
+    case MaphSAT::Heuristic::RDLIS:
+        return selectSearchLoop<MaphSAT::Heuristic::RDLIS>(options);
+    case MaphSAT::Heuristic::DLCS:
+        return selectSearchLoop<MaphSAT::Heuristic::DLCS>(options);
+    case MaphSAT::Heuristic::RDLCS:
+        return selectSearchLoop<MaphSAT::Heuristic::RDLCS>(options);
+    case MaphSAT::Heuristic::JW:
+        return selectSearchLoop<MaphSAT::Heuristic::JW>(options);
+    case MaphSAT::Heuristic::RJW:
+        return selectSearchLoop<MaphSAT::Heuristic::RJW>(options);
+    case MaphSAT::Heuristic::MOMS:
+        return selectSearchLoop<MaphSAT::Heuristic::MOMS>(options);
+    case MaphSAT::Heuristic::RMOMS:
+        return selectSearchLoop<MaphSAT::Heuristic::RMOMS>(options);
+    case MaphSAT::Heuristic::VSIDS:
+        return selectSearchLoop<MaphSAT::Heuristic::VSIDS>(options);
+    }
+    return &MaphSAT::searchWith<DynamicPolicy>;
+#endif
+}
+
+template <MaphSAT::Heuristic H>
+MaphSAT::SearchLoop MaphSAT::selectSearchLoop(const MaphSAT::Options & options) {
+    switch (options.restarts) {
+    case RestartScheduler::Policy::NONE:
+        return selectSearchLoop<H, RestartScheduler::Policy::NONE>(options);
+    case RestartScheduler::Policy::LUBY:
+        return selectSearchLoop<H, RestartScheduler::Policy::LUBY>(options);
+    case RestartScheduler::Policy::GLUCOSE:
+        return selectSearchLoop<H, RestartScheduler::Policy::GLUCOSE>(options);
+    }
+    return &MaphSAT::searchWith<DynamicPolicy>;
+}
+
+template <MaphSAT::Heuristic H, RestartScheduler::Policy R>
+MaphSAT::SearchLoop MaphSAT::selectSearchLoop(const MaphSAT::Options & options) {
+    if (options.gaussianElimination)
+        return selectSearchLoop<H, R, true>(options);
+    return selectSearchLoop<H, R, false>(options);
+}
+
+template <MaphSAT::Heuristic H, RestartScheduler::Policy R, bool Xors>
+MaphSAT::SearchLoop MaphSAT::selectSearchLoop(const MaphSAT::Options & options) {
+    if (options.pureLiterals)
+        return &MaphSAT::searchWith<StaticPolicy<H, R, Xors, true> >;
+    return &MaphSAT::searchWith<StaticPolicy<H, R, Xors, false> >;
+}
+
+// The resident memory of the process in megabytes, or 0 where /proc is not available.
+static std::size_t residentMegabytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    if (!(statm >> pages >> resident))
+        return 0;
+    return resident * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+bool MaphSAT::checkLimits(bool readResources) {
+    if (limit != MaphSAT::Limit::NONE)
+        return true;
+    if (numberPropagations >= nextResourceCheck)
+        readResources = true;
+    if (readResources)
+        nextResourceCheck = numberPropagations + resourceCheck;
+    if (options.conflictLimit != 0 && numberConflicts >= options.conflictLimit)
+        limit = MaphSAT::Limit::CONFLICTS;
+    else if (options.propagationLimit != 0 && numberPropagations >= options.propagationLimit)
+        limit = MaphSAT::Limit::PROPAGATIONS;
+    else if (readResources && options.timeLimit > 0 && stats.elapsed() >= options.timeLimit)
+        limit = MaphSAT::Limit::TIME;
+    else if (readResources && options.memoryLimit != 0 && residentMegabytes() >= options.memoryLimit)
+        limit = MaphSAT::Limit::MEMORY;
+    return limit != MaphSAT::Limit::NONE;
+}
+
+double MaphSAT::Statistics::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double MaphSAT::Statistics::seconds(std::uint64_t cycles) const {
+    const std::uint64_t elapsedCycles = readCycles() - startCycles;
+    return elapsedCycles == 0 ? 0.0 : elapsed() * cycles / elapsedCycles;
+}
+
+// Print the conflicts and propagations per second since the last progress line, the size of the
+// trail with the literals fixed at level 0 and the number of learned clauses. The line is built
+// first, so that it is written at once.
+void MaphSAT::printProgress() {
+    const auto now = std::chrono::steady_clock::now();
+    const double interval = std::chrono::duration<double>(now - lastProgress).count();
+    if (interval < 1.0)
+        return;
+
+    std::size_t learned = 0;
+    for (ClauseRef ref : formula) {
+        if (arena[ref].learned() && !arena[ref].deleted())
+            ++learned;
+    }
+    const std::size_t fixed = trailLimits.empty() ? trail.size() : trailLimits[0];
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "c progress " << stats.elapsed() << " s: "
+         << numberConflicts << " conflicts (" << static_cast<std::size_t>((numberConflicts - progressConflicts) / interval)
+         << "/s), " << numberPropagations << " propagations ("
+         << static_cast<std::size_t>((numberPropagations - progressPropagations) / interval) << "/s), trail "
+         << trail.size() << " (" << fixed << " fixed), " << learned << " learned clauses\n";
+    std::cerr << line.str();
+
+    lastProgress = now;
+    progressConflicts = numberConflicts;
+    progressPropagations = numberPropagations;
+}
+
+void MaphSAT::printStatistics(std::ostream & out) const {
+    const double elapsed = std::max(stats.elapsed(), 1e-9);
+    const auto average = [](std::size_t sum, std::size_t count) {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+    };
+
+    static const char * const limitNames[] = {"none", "interrupted", "conflict limit", "propagation limit",
+        "time limit", "memory limit"};
+
+    std::ostringstream lines;
+    lines << std::fixed << std::setprecision(2) << std::left;
+    if (limit != MaphSAT::Limit::NONE)
+        lines << "c " << std::setw(21) << "stopped by" << limitNames[static_cast<int>(limit)] << "\n";
+    const auto count = [&lines, elapsed](const char * name, std::size_t number) {
+        lines << "c " << std::setw(21) << name << number << " (" << static_cast<std::size_t>(number / elapsed) << "/s)\n";
+    };
+    lines << "c " << std::setw(21) << "time" << elapsed << " s\n";
+    count("decisions", numberDecisions);
+    count("conflicts", numberConflicts);
+    count("propagations", numberPropagations);
+    lines << "c " << std::setw(21) << "restarts" << stats.restarts << "\n"
+          << "c " << std::setw(21) << "learned clauses" << stats.learnedClauses << " ("
+          << average(stats.learnedLiterals, stats.learnedClauses) << " literals and LBD "
+          << average(stats.learnedLBD, stats.learnedClauses) << " on average, "
+          << 100 * average(stats.minimizedLiterals, stats.learnedLiterals + stats.minimizedLiterals)
+          << " % of the literals removed by minimization)\n"
+          << "c " << std::setw(21) << "reductions" << stats.reductions << " (" << stats.deletedClauses << " clauses deleted)\n";
+    if (options.inprocess)
+        lines << "c " << std::setw(21) << "inprocessing rounds" << stats.inprocessings << "\n";
+    if (options.pureLiterals)
+        lines << "c " << std::setw(21) << "pure literals" << stats.pureLiterals << "\n";
+    if (exports != nullptr)
+        lines << "c " << std::setw(21) << "exported clauses" << stats.exportedClauses << "\n";
+    if (!imports.empty())
+        lines << "c " << std::setw(21) << "imported clauses" << stats.importedClauses << "\n";
+
+    if (options.timePhases) {
+        lines << "c " << std::setw(21) << "phase times" << "preprocess " << times.preprocess << " s, propagate "
+              << times.propagate << " s, analyze " << times.analyze << " s, decide " << times.decide << " s\n";
+    }
+
+    // The timed functions call each other in places, such as inprocessing propagating literals,
+    // so their shares may add up to more than the whole.
+    if (profiling) {
+        const auto profile = [&lines, elapsed, this](const char * name, std::uint64_t cycles) {
+            const double seconds = stats.seconds(cycles);
+            lines << "c " << std::setw(21) << name << seconds << " s (" << 100 * seconds / elapsed << " %)\n";
+        };
+        profile("notifyWatches", stats.watchCycles);
+        if (options.gaussianElimination)
+            profile("propagateXors", stats.xorCycles);
+        profile("applyExplainUIP", stats.explainCycles);
+        profile("applyLearn/Backjump", stats.learnCycles);
+        profile("applyDecide", stats.decideCycles);
+        profile("reduceDatabase", stats.reduceCycles);
+        if (options.inprocess)
+            profile("inprocess", stats.inprocessCycles);
+    }
+
+    out << lines.str();
+}
+
 // Print the current state of the SAT solver.
 std::ostream & operator<<(std::ostream & out, const MaphSAT & maph) {
     switch (maph.state) {
-    case MaphSAT::State::UNDEF:
-        out << "UNDEF\n";
+    case MaphSAT::State::UNKNOWN:
+        out << "s UNKNOWN\n";
         break;
     case MaphSAT::State::SAT:
         out << "s SATISFIABLE\n";
-        // to use the runTests.py script, change the output to "SAT"
         break;
     case MaphSAT::State::UNSAT:
         out << "s UNSATISFIABLE\n";
-        // to use the runTests.py script, change the output to "UNSAT"
         break;
     }
 
-    // to use the runTests.py script, uncomment the following output
     if (maph.state == MaphSAT::State::SAT) {
         out << "v ";
-        for (const auto & literal : maph.trail)
-            out << literal.first << ' ';
+        for (std::uint32_t variable = 1; variable <= maph.numberVariables; ++variable)
+            out << toDimacs(makeLiteral(variable, maph.model[variable] < 0)) << ' ';
     }
 
     return out;
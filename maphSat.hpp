@@ -1,14 +1,25 @@
 #ifndef __MAPHSAT_HPP__
 #define __MAPHSAT_HPP__
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
-#include <deque>
 #include <functional>
 #include <iostream>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "maphClause.hpp"
+#include "maphDimacs.hpp"
+#include "maphGauss.hpp"
+#include "maphHeap.hpp"
+#include "maphPreprocess.hpp"
+#include "maphRandom.hpp"
+#include "maphRestart.hpp"
+#include "maphShare.hpp"
+#include "maphTimer.hpp"
+
 class MaphSAT {
 
 public:
@@ -23,63 +34,481 @@ public:
         JW,
         RJW,
         MOMS,
-        RMOMS
+        RMOMS,
+        VSIDS
     };
     Heuristic heuristic;
 
+    // How local search takes part in solving. PHASES runs local search once before the
+    // search and uses the best assignment it finds as the saved phases. ONLY repeats local
+    // search until it finds a model, so it never answers for an unsatisfiable formula.
+    enum class LocalSearchMode {
+        NONE,
+        PHASES,
+        ONLY
+    };
+
+    // Search options that can be selected from the command line.
+    struct Options {
+        // When to restart the search from decision level 0.
+        RestartScheduler::Policy restarts;
+        // Decide each variable with the polarity it had when it was last unassigned.
+        bool phaseSaving;
+        // Periodically delete learned clauses of low value.
+        bool reduceDatabase;
+        // Simplify the formula before the search.
+        bool preprocess;
+        // Periodically simplify the formula during the search.
+        bool inprocess;
+        // Seeds the random choices of the randomized heuristics and of local search. If not 0, it
+        // also perturbs the initial VSIDS order and the initial saved phases.
+        std::uint64_t seed;
+        // Local search before the search. Any mode other than NONE implies phase saving.
+        LocalSearchMode localSearch;
+        // Propagate the XOR constraints encoded in the formula by Gaussian elimination.
+        bool gaussianElimination;
+        // Decide pure literals before asking the heuristic. Implies the occurrence counters.
+        bool pureLiterals;
+        // Measure the time spent in each phase of solving.
+        bool timePhases;
+        // Print a progress line to the standard error about once a second during the search.
+        bool progress;
+        // Give up once the solver has made this many conflicts or propagations over all calls to
+        // 'solve', after this many seconds since it started reading the formula, or once the
+        // process has this many megabytes of resident memory. 0 means no limit.
+        std::size_t conflictLimit;
+        std::size_t propagationLimit;
+        double timeLimit;
+        std::size_t memoryLimit;
+
+        Options() : restarts(RestartScheduler::Policy::NONE), phaseSaving(false), reduceDatabase(true),
+            preprocess(false), inprocess(false), seed(0), localSearch(LocalSearchMode::NONE),
+            gaussianElimination(false), pureLiterals(false), timePhases(false), progress(false), conflictLimit(0),
+            propagationLimit(0), timeLimit(0), memoryLimit(0) {}
+
+        // Apply the command line option 'arguments[index]' of 'count' arguments and move 'index'
+        // to its last argument. Returns false if it is not a solver option or has an invalid argument.
+        bool parse(const char * const * arguments, int count, int & index);
+    };
+    Options options;
+
+    // The time in seconds spent in each phase, measured if 'Options::timePhases' is set.
+    // Parsing is only measured when the solver reads a DIMACS parser itself. Preprocessing
+    // includes setting up the solver for the formula. The other phases are summed over all
+    // calls to 'solve'; backjumping counts as conflict analysis.
+    struct PhaseTimes {
+        double parse;
+        double preprocess;
+        double propagate;
+        double analyze;
+        double decide;
+
+        PhaseTimes() : parse(0), preprocess(0), propagate(0), analyze(0), decide(0) {}
+    };
+
+    // Counters of the events of the search, summed over all calls to 'solve', and the cycles
+    // spent in its hot functions, which are only counted when profiling. Every counter is
+    // incremented once per conflict or less often, so counting costs nothing measurable.
+    struct Statistics {
+        std::size_t restarts;
+        std::size_t learnedClauses;
+        // The literals and the sum of the LBDs of the learned clauses, and the literals
+        // removed from them by minimization.
+        std::size_t learnedLiterals;
+        std::size_t learnedLBD;
+        std::size_t minimizedLiterals;
+        std::size_t reductions;
+        std::size_t deletedClauses;
+        std::size_t inprocessings;
+        std::size_t pureLiterals;
+        std::size_t exportedClauses;
+        std::size_t importedClauses;
+
+        std::uint64_t watchCycles;
+        std::uint64_t xorCycles;
+        std::uint64_t explainCycles;
+        std::uint64_t learnCycles;
+        std::uint64_t decideCycles;
+        std::uint64_t reduceCycles;
+        std::uint64_t inprocessCycles;
+
+        // When the statistics started, to convert cycles to seconds.
+        std::chrono::steady_clock::time_point start;
+        std::uint64_t startCycles;
+
+        Statistics() : restarts(0), learnedClauses(0), learnedLiterals(0), learnedLBD(0), minimizedLiterals(0),
+            reductions(0), deletedClauses(0), inprocessings(0), pureLiterals(0), exportedClauses(0), importedClauses(0),
+            watchCycles(0), xorCycles(0), explainCycles(0), learnCycles(0), decideCycles(0), reduceCycles(0),
+            inprocessCycles(0), start(std::chrono::steady_clock::now()), startCycles(readCycles()) {}
+
+        // The seconds since the statistics started.
+        double elapsed() const;
+
+        // Convert a number of cycles to seconds at the rate measured since the statistics started.
+        double seconds(std::uint64_t cycles) const;
+    };
+
+    // Why the last call to 'solve' returned without an answer: NONE if it had an answer or used
+    // up the conflict budget of a cube, INTERRUPTED, or the limit of the options that ran out.
+    enum class Limit {
+        NONE,
+        INTERRUPTED,
+        CONFLICTS,
+        PROPAGATIONS,
+        TIME,
+        MEMORY
+    };
+
 private:
 
     enum class State {
-        UNDEF,  // The formula has not yet been found to be satisfiable or unsatisfiable.
-        SAT,    // The formula is satisfiable.
-        UNSAT   // The formula is unsatisfiable.
+        UNKNOWN,  // The formula has not been found to be satisfiable or unsatisfiable, yet or within the limits.
+        SAT,      // The formula is satisfiable.
+        UNSAT     // The formula is unsatisfiable.
     };
     State state;
 
+    // The search loop and the functions it runs on every step are templates over a policy that
+    // selects the decision literals, decides when to restart and tells which optional features
+    // are active. A StaticPolicy fixes all of them at compile time, so that every combination of
+    // heuristic, restart policy, XOR propagation and pure literal decisions gets a loop of its own
+    // without any dispatch on the heuristic or the options. The DynamicPolicy reads them from the
+    // solver at runtime. It is used outside the search loop, and by the search loop when compiled
+    // with MAPH_GENERIC.
+    template <Heuristic H, RestartScheduler::Policy R, bool Xors, bool Pure>
+    struct StaticPolicy;
+    struct DynamicPolicy;
+
     std::size_t numberVariables;
     std::size_t numberClauses;
     std::size_t numberDecisions;
+    std::size_t numberConflicts;
+    std::size_t numberPropagations;
+
+    // The index of the first literal in the trail that has not been propagated yet.
+    std::size_t propagationHead;
 
     bool conflict;
 
-    // The formula in CNF format. Each inner vector represents a clause.
-    std::vector<std::vector<int> > formula;
+    // The clause that has been falsified by the current assignment.
+    ClauseRef conflictClause;
+
+    // Holds the literals of all clauses with at least two literals.
+    ClauseArena arena;
 
-    // The trail represents the current partial evaluation, with each pair being
-    // a literal and a boolean denoting whether it is a decision literal or not.
-    std::vector<std::pair<int, bool> > trail;
+    // The formula in CNF format. Each entry references a clause in the arena.
+    std::vector<ClauseRef> formula;
+
+    // The trail represents the current partial evaluation as the asserted literals in the
+    // order of their assertion.
+    std::vector<Literal> trail;
+
+    // The index in the trail at which each decision level starts. The first literal of
+    // each level is its decision literal.
+    std::vector<std::size_t> trailLimits;
+
+    // The current decision level.
+    std::size_t decisionLevel() const { return trailLimits.size(); }
 
     // The variable assignment that lead to a conflict and its opposite.
-    std::vector<int> backjumpClause;
+    std::vector<Literal> backjumpClause;
+
+    // The value of each variable indexed by variable: 1 if true, -1 if false and 0 if unassigned.
+    std::vector<signed char> values;
+
+    // The decision level at which each variable has been assigned, indexed by variable.
+    std::vector<std::size_t> levels;
+
+    // The clause that forced the propagation of each variable, indexed by variable. Decisions
+    // and unit clauses have no reason.
+    std::vector<ClauseRef> reasons;
+
+    // Maps a literal to the clauses with more than two literals that are watching the literal.
+    std::vector<std::vector<Watch> > watchList;
+
+    // Maps a literal to the binary clauses containing it. The blocker of each entry is the
+    // literal that is implied once the literal is falsified.
+    std::vector<std::vector<Watch> > binaryList;
+
+    // Add a clause to the watch lists of its first two literals.
+    void watchClause(ClauseRef);
+
+    // Unassigned variables ordered by their VSIDS activity.
+    VariableHeap activityHeap;
+
+    // The amount added to the activity of a variable involved in a conflict. It grows
+    // after every conflict, which decays all earlier bumps geometrically (EVSIDS).
+    double activityIncrement;
+    static constexpr double activityDecay = 0.95;
+
+    // Increase the activity of the variable of 'literal'.
+    void bumpActivity(Literal literal);
+
+    // Decay the activities of all variables after a conflict.
+    void decayActivities();
+
+    // Decides when to restart the search.
+    RestartScheduler restartScheduler;
+
+    // The last polarity of each variable, indexed by variable: 1 if true, -1 if false
+    // and 0 if the variable has never been assigned.
+    std::vector<signed char> savedPhases;
+
+    // Used to count the distinct decision levels of a clause. A level has been seen
+    // if its stamp equals 'currentStamp'.
+    std::vector<std::size_t> levelStamps;
+    std::size_t currentStamp;
+
+    // Returns the literal block distance of a clause, which is the number of
+    // distinct decision levels among its literals.
+    template <typename Iterator>
+    std::size_t computeLBD(Iterator, Iterator);
+
+    // Undo all decisions, keeping the literals asserted at level 0.
+    template <typename Policy = DynamicPolicy>
+    void restart();
+
+    // The clauses removed by preprocessing, which extend the model of the simplified
+    // formula to the eliminated variables.
+    ReconstructionStack reconstruction;
+
+    // Whether each variable has been eliminated by preprocessing or substituted by
+    // inprocessing, indexed by variable. Such variables occur in no clause.
+    std::vector<char> eliminated;
+
+    // The literal that replaced the positive literal of each substituted variable, indexed by
+    // variable, or noLiteral. The replacement may have been substituted later as well.
+    std::vector<Literal> substitutes;
 
-    // Maps a propagated literal to the clause that forced its propagation.
-    std::unordered_map<int, std::size_t> reason;
+    // Returns the literal that stands for 'literal' in the current formula.
+    Literal substitute(Literal literal) const;
 
-    // Literals than can be unit propagated and the clause that forced the propagation.
-    std::deque<int> unitQueue;
+    // The model found by the last call to 'solve', extended to the eliminated variables.
+    std::vector<signed char> model;
 
-    // Maps a literal to the clauses that are watching the literal.
-    std::unordered_map<int, std::vector<std::size_t> > watchList;
+    // The literals that the current call to 'solve' assumes to be true. They are decided
+    // first, one decision level each, in this order.
+    std::vector<Literal> assumptions;
 
-    void combinedSum(std::vector<std::pair<int, int> > &, std::vector<std::pair<int, int> > &, bool, std::size_t) const;
-    int selectFirst() const;
-    int selectRandom() const;
-    int selectDLIS(bool) const;
-    int selectDLCS(bool) const;
-    int selectJW(bool) const;
-    int selectMOMS(bool) const;
+    // Whether the last call to 'solve' found that no model satisfies the assumptions,
+    // while the formula itself may still be satisfiable.
+    bool assumptionsRefuted;
 
-    // Elimiate pure literals.
-    void pureLiteral();
+    // The assumptions that have been decided, or propagated at level 0, and that together
+    // imply the negation of the assumption that was found false.
+    std::vector<Literal> failedAssumptions;
 
-    // Assert a literal as a decision literal or as a non-decision literal.
-    void assertLiteral(int, bool);
+    // Collect the assumptions the falsified assumption 'literal' depends on into
+    // 'failedAssumptions' by following the reasons back from it.
+    void analyzeFinal(Literal literal);
+
+    // Search until the formula is solved under 'assumptions', or until 'conflictBudget'
+    // conflicts have been spent.
+    bool search(std::size_t conflictBudget) { return (this->*searchLoop)(conflictBudget); }
+    template <typename Policy>
+    bool searchWith(std::size_t conflictBudget);
+
+    // The instantiation of 'searchWith' for the heuristic and the options of the solver, chosen
+    // once when the solver is constructed.
+    typedef bool (MaphSAT::* SearchLoop)(std::size_t);
+    SearchLoop searchLoop;
+    static SearchLoop selectSearchLoop(Heuristic, const Options &);
+    template <Heuristic H>
+    static SearchLoop selectSearchLoop(const Options &);
+    template <Heuristic H, RestartScheduler::Policy R>
+    static SearchLoop selectSearchLoop(const Options &);
+    template <Heuristic H, RestartScheduler::Policy R, bool Xors>
+    static SearchLoop selectSearchLoop(const Options &);
+
+    // Make room for the variables up to 'variables'.
+    void growVariables(std::size_t variables);
+
+    // Convert a DIMACS literal given by the user, mapping it to the variable that stands for
+    // it. Throws invalid_argument() for 0 and for variables eliminated by preprocessing.
+    Literal userLiteral(int literal);
+
+    std::vector<Literal> addedClause;
+
+    // The number of literals 'lookahead' tries to split a cube on.
+    static constexpr std::size_t lookaheadCandidates = 32;
+
+    // Assert each literal whose assertion leads to a conflict by unit propagation
+    // ("failed literal") negated at level 0, within a budget of propagated literals.
+    void probeFailedLiterals();
+    static constexpr std::size_t probeBudget = 10000000;
+    // The limits are checked once every 'probeCheck' variables.
+    static constexpr std::uint32_t probeCheck = 1024;
+
+    // START INPROCESSING
+
+    // The formula is simplified at level 0 once 'numberConflicts' reaches 'nextInprocessing'.
+    // The interval between inprocessing rounds grows by half each time.
+    std::size_t nextInprocessing;
+    std::size_t inprocessingInterval;
+
+    // The number of propagations at the end of the last inprocessing round.
+    std::size_t lastInprocessing;
+
+    // The work of each technique is limited to a share of the propagations of the search
+    // since the last round, so that inprocessing takes at most about a tenth of the runtime.
+    static constexpr double equivalenceShare = 0.02;
+    static constexpr double subsumptionShare = 0.02;
+    static constexpr double vivificationShare = 0.06;
+
+    // Run all inprocessing techniques. Must be called at level 0 after propagation.
+    void inprocess();
+
+    // Remove the clauses satisfied at level 0 and the falsified literals of all other clauses.
+    void simplifyLevelZero();
+
+    // Replace the literals of each strongly connected component of the binary implication
+    // graph by one representative literal.
+    void substituteEquivalences(std::size_t budget);
+
+    // Delete the learned clauses that are subsumed by another learned clause.
+    void subsumeLearned(std::size_t budget);
+
+    // Shorten learned clauses by propagating the negations of their literals.
+    void vivifyLearned(std::size_t budget);
+
+    // Remove a clause from the watch lists.
+    void unwatchClause(ClauseRef);
+
+    // Assert the literals at level 0 and propagate them.
+    void assertLevelZero(const std::vector<Literal> &);
+
+    // START GAUSSIAN ELIMINATION
+
+    // The XOR constraints of the formula, propagated alongside the clauses. Each literal the
+    // matrix implies gets the row it came from as its reason clause, and a falsified row
+    // becomes the conflict clause.
+    GaussMatrix gauss;
+    static constexpr std::size_t maximumXorSize = 5;
+
+    // The clauses recorded by the matrix. They are not watched and not part of the formula,
+    // and garbage collection keeps only those that are still reasons.
+    std::vector<ClauseRef> xorReasons;
+
+    // Detect the XOR constraints of the formula and set up the matrix. Must be called at level 0.
+    // Substituting variables invalidates the matrix, so it is rebuilt after inprocessing.
+    void buildGaussMatrix();
+
+    // Update the matrix once 'literal' has been asserted, and assert the literals it implies.
+    template <typename Policy = DynamicPolicy>
+    void propagateXors(Literal literal);
+
+    // START LEARNED CLAUSE DATABASE
+
+    // Learned clauses are kept in three tiers by their LBD. Core clauses (LBD <= 2) are
+    // never deleted. Tier-2 clauses (LBD <= 6) are kept as long as they have been used in
+    // conflict analysis since the last reduction. All other clauses are local, and the
+    // half of them with the lowest activity is deleted by each reduction.
+    static constexpr std::uint32_t coreLBD = 2;
+    static constexpr std::uint32_t tier2LBD = 6;
+
+    // The database is reduced once 'numberConflicts' reaches 'nextReduction'. The interval
+    // between reductions grows by 'reductionIncrement' each time.
+    std::size_t nextReduction;
+    std::size_t reductionInterval;
+    static constexpr std::size_t reductionIncrement = 300;
+
+    // The amount added to the activity of a learned clause used in conflict analysis.
+    float clauseActivityIncrement;
+    static constexpr float clauseActivityDecay = 0.999f;
+
+    // Increase the activity of a learned clause, mark it as used and update its LBD.
+    void bumpClause(ClauseRef);
+
+    // Is the clause the reason for a literal in the trail?
+    bool isLocked(ClauseRef) const;
+
+    // Delete learned clauses of low value and compact the clause arena.
+    void reduceDatabase();
+
+    // Copy the clauses that are not deleted into a new arena, update all references to
+    // them and rebuild the watch lists.
+    void garbageCollect();
+
+    // Recompute the occurrence counters from scratch.
+    void rebuildOccurrences();
+
+    // Whether the occurrence counters below are maintained. Only the DLIS, DLCS, JW
+    // and MOMS heuristics (and their randomized variants) and pure literals need them.
+    bool countOccurrences;
+
+    // Maps a literal to the indices in 'formula' of the clauses containing the literal.
+    std::vector<std::vector<std::size_t> > occurrences;
+
+    // The number of true literals of each clause. A clause is unsatisfied if it has none.
+    std::vector<std::size_t> trueLiterals;
+
+    // For each literal, the number of unsatisfied clauses containing the literal (DLIS, DLCS),
+    // the sum of 2^-|clause| over those clauses (JW) and the number of those clauses that
+    // are no longer than 'momsCutoff' (MOMS).
+    std::vector<int> occurrenceCount;
+    std::vector<double> jwWeight;
+    std::vector<int> shortCount;
+    std::size_t momsCutoff;
+
+    // Update the occurrence counters of the literals of a clause when the clause
+    // becomes satisfied (-1) or unsatisfied again (1).
+    template <typename Policy = DynamicPolicy>
+    void updateCounters(std::size_t, int);
+
+    // Start tracking the occurrences of the literals of a clause.
+    template <typename Policy = DynamicPolicy>
+    void addOccurrences(std::size_t);
+
+    // A literal is pure if it occurs in an unsatisfied clause and its negation occurs in none.
+    // Every unassigned pure literal is on this stack, which the occurrence counters push a
+    // literal onto whenever it may have become pure. Literals that are no longer pure or
+    // have been assigned are dropped once they are popped.
+    std::vector<Literal> pureCandidates;
+
+    bool isPure(Literal literal) const {
+        return occurrenceCount[literal] > 0 && occurrenceCount[negate(literal)] == 0;
+    }
+
+    // Pop candidates until an unassigned pure literal is found. Returns noLiteral if there is none.
+    Literal nextPureLiteral();
+
+    // Returns 1 if 'literal' is true, -1 if it is false and 0 if it is unassigned.
+    int value(Literal literal) const {
+        const int v = values[variableOf(literal)];
+        return isNegative(literal) ? -v : v;
+    }
+
+    // The randomized variants of the heuristics break ties at random.
+    template <bool Random, typename Score>
+    Literal selectMaxScore(Score);
+    Literal selectFirst() const;
+    Literal selectRandom();
+    template <bool Random>
+    Literal selectDLIS();
+    template <bool Random>
+    Literal selectDLCS();
+    template <bool Random>
+    Literal selectJW();
+    template <bool Random>
+    Literal selectMOMS();
+    Literal selectVSIDS();
+
+    // Select a decision literal with heuristic 'H'.
+    template <Heuristic H>
+    Literal select();
+
+    // Assert a literal as a decision literal or as a non-decision literal
+    // propagated by the given clause.
+    template <typename Policy = DynamicPolicy>
+    void assertLiteral(Literal, bool, ClauseRef = noClause);
 
     // Select a literal that is not yet asserted and assert it as a decision literal.
+    template <typename Policy = DynamicPolicy>
     void applyDecide();
 
     // If there are any unit literals due to the current partial evaluation, assert
     // them as non-decision literals. Repeat until there are no more unit literals.
+    template <typename Policy = DynamicPolicy>
     void applyUnitPropagate();
 
     // START CONFLICT RESOLUTION
@@ -105,57 +534,216 @@ private:
     // must pass through it. Then the conflict clause consists of all nodes, belonging
     // to the reason side, that have an edge into the conflict side.
 
-    // Returns the number of decision literals in the trail that precede the first
-    // occurance of 'literal', including 'literal' itself if it is a decision literal.
-    std::size_t level(int literal) const;
+    // Returns the decision level at which 'literal' has been asserted, which is the
+    // number of decision literals in the trail up to and including 'literal'.
+    std::size_t level(Literal literal) const;
+
+    // Marks the variables that are part of the current conflict analysis, indexed by variable.
+    std::vector<char> seen;
 
-    // Returns a literal from 'clause' that is in the trail such that no other
-    // literal from 'clause' comes after it in the trail.
-    int lastAssertedLiteral() const;
+    // Literals whose marks have to be cleared once the analysis is done, and the work
+    // stack used by 'isRedundant'.
+    std::vector<Literal> analyzeClear;
+    std::vector<Literal> analyzeStack;
 
-    //int lastAssertedLiteralNonDecision(const std::vector<int> &) const;
+    // Construct the backjump clause by walking the trail backwards from the conflict.
+    // Every marked literal of the current decision level is explained by its reason
+    // clause until only one of them, the first UIP, remains.
+    template <typename Policy = DynamicPolicy>
+    void applyExplainUIP();
 
-    // Check if the backjump clause satisfies the first UIP condition, which is the
-    // case if the backjump clause contains exactly one literal of the current decision level.
-    bool isUIP() const;
+    // Returns a bit set with one bit for the decision level of the variable of 'literal'.
+    std::uint32_t abstractLevel(Literal literal) const {
+        return 1u << (levels[variableOf(literal)] & 31);
+    }
 
-    // Perform a single resolution step between the backjump clause and a clause
-    // that is the reason for the propagation of -'literal'.
-    void applyExplain(int);
+    // Check if a literal of the backjump clause is implied by the other literals of the
+    // clause, following reason clauses recursively. The second argument is the union of the
+    // abstract levels of the clause and lets the search give up early.
+    bool isRedundant(Literal, std::uint32_t);
 
-    // Construct the backjump clause by repeatedly explaining a literal that lead to a
-    // conflict until the backjump clause satisfies the first UIP condition.
-    void applyExplainUIP();
+    // Remove all redundant literals from the backjump clause.
+    void minimizeBackjumpClause();
 
     // Add a learned clause to the formula to prevent the same conflict from happening again.
+    template <typename Policy = DynamicPolicy>
     void applyLearn();
 
-    // Return an iterator to the first literal in the trail that has a decision level greater than 'level'.
-    std::vector<std::pair<int, bool> >::iterator firstLiteralPast(int);
+    // Remove any literals from the trail that have a decision level greater than 'level'. Their
+    // values become the saved phases unless 'savePhases' is false, as for probe assignments.
+    template <typename Policy = DynamicPolicy>
+    void removePast(std::size_t, bool savePhases = true);
 
-    // Remove any literals from the trail that have a decision level greater than 'level'.
-    void removePast(int);
-
-    // Return the greatest decision level of the backjump clause exluding 'literal'.
-    int getBackjumpLevel(int);
+    // Return the greatest decision level of the backjump clause exluding its first literal.
+    std::size_t getBackjumpLevel() const;
 
     // Backtrack literals from the trail until the backjump clause becomes a unit
     // clause and then assert the unit literal.
+    template <typename Policy = DynamicPolicy>
     void applyBackjump();
 
     // Notify clauses that a literal has been asserted.
-    void notifyWatches(int);
-
-    //bool pureLiteral();
+    template <typename Policy = DynamicPolicy>
+    void notifyWatches(Literal);
+
+    // Set by 'interrupt' to stop the search, and by 'interruptAll' to stop the search of every solver.
+    std::atomic<bool> interrupted;
+    static std::atomic<bool> allInterrupted;
+    static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "interrupting from a signal handler needs a lock-free flag");
+
+    bool isInterrupted() const {
+        return interrupted.load(std::memory_order_relaxed) || allInterrupted.load(std::memory_order_relaxed);
+    }
+
+    Limit limit;
+
+    // Has a limit of the options run out? If so, it is recorded in 'limit'. The conflicts and
+    // propagations are compared on every step of the search, but the clock and the resident
+    // memory are only read if 'readResources' is set, once every 'progressCheck' conflicts, or
+    // once 'resourceCheck' propagations have passed since they were last read, which covers
+    // long stretches of propagation without conflicts.
+    bool checkLimits(bool readResources);
+    static constexpr std::size_t resourceCheck = 100000;
+    std::size_t nextResourceCheck;
+
+    // Learned clauses that are short or have a low LBD are exported to 'exports', and the
+    // clauses exported by other solvers are imported from 'imports' at level 0. Each import
+    // is a buffer and the position up to which it has been read.
+    ClauseBuffer * exports;
+    std::vector<std::pair<const ClauseBuffer *, std::size_t> > imports;
+    static constexpr std::size_t exportSize = 8;
+    std::vector<Literal> importedClause;
+
+    // Add the clauses exported by other solvers since the last import. Must be called at
+    // level 0 after propagation.
+    void importClauses();
+
+    // Whether local search has run on the current formula. Adding a clause makes it run again.
+    bool localSearched;
+
+    // Makes every random choice of the solver, seeded by 'Options::seed' whenever a formula is set up.
+    RandomGenerator generator;
+
+    // Run local search from the saved phases and save the phases of the best assignment it
+    // finds. Its flips are limited to 'localSearchEffort' per clause, or repeated until it
+    // finds a model in the ONLY mode. Must be called at level 0 after propagation.
+    void localSearch();
+    static constexpr std::size_t localSearchEffort = 100;
+
+    // Size the tables of the solver for 'numberVariables' variables and 'numberClauses' clauses.
+    void allocate();
+
+    // Add a clause of the input formula. Unit clauses are collected in 'units' and
+    // asserted by 'finishInput' once the solver is set up.
+    void addInputClause(const std::vector<Literal> & clause, std::vector<Literal> & units);
+
+    // Preprocess the input formula if enabled, watch the clauses, set up the occurrence
+    // counters and assert the unit clauses.
+    void finishInput(std::vector<Literal> & units);
+
+    // Read the formula of a DIMACS parser into an empty solver.
+    void read(DimacsParser &);
+
+    // Forget the formula and the state of the search, keeping the memory of the clause
+    // arena, the trail and the watch lists.
+    void reset();
+
+    PhaseTimes times;
+    Statistics stats;
+
+    // The progress line is printed once the last one is a second old. The clock is only read
+    // every 'progressCheck' conflicts. The rates are taken over the counts since the last line.
+    static constexpr std::size_t progressCheck = 100;
+    std::chrono::steady_clock::time_point lastProgress;
+    std::size_t progressConflicts;
+    std::size_t progressPropagations;
+
+    // Print a progress line to the standard error if it is time for one.
+    void printProgress();
+
+    // The conflicts before the first inprocessing round and the first database reduction.
+    static constexpr std::size_t firstInprocessing = 5000;
+    static constexpr std::size_t firstReduction = 2000;
 
 public:
 
+    // Initialize the solver without any variables or clauses, for incremental use. Clauses
+    // are added with 'addClause', and variables are created as they occur.
+    MaphSAT(Heuristic, const Options &);
+
     // Parse a CNF formula and throw invalid_argument() if unsuccessful.
     MaphSAT(std::istream &, Heuristic);
+    MaphSAT(std::istream &, Heuristic, const Options &);
+
+    // Load a CNF formula from a DIMACS parser, which throws invalid_argument() if unsuccessful.
+    MaphSAT(DimacsParser &, Heuristic, const Options &);
+
+    // Replace the formula by the one read from a DIMACS parser, which throws invalid_argument()
+    // if unsuccessful. The memory of the previous formula is reused.
+    void load(DimacsParser &);
+
+    // Set up the solver for a formula that has already been parsed. The clauses are copied,
+    // as the solver reorders the literals of its clauses.
+    MaphSAT(const Formula &, Heuristic, const Options &);
 
     // Solve the CNF formula.
     bool solve();
 
+    // Add a clause of DIMACS literals to the formula, between calls to 'solve'. Returns false
+    // if the formula has become unsatisfiable. Throws invalid_argument() if the clause contains
+    // 0 or a variable eliminated by preprocessing.
+    bool addClause(const std::vector<int> & clause);
+
+    // Solve the CNF formula under the assumption that the given DIMACS literals are true.
+    // Returns true if a model has been found. Learned clauses, activities and saved phases
+    // are kept between calls, and all assignments that depend on the assumptions are undone
+    // before the next call. Throws invalid_argument() like 'addClause'.
+    bool solve(const std::vector<int> & assumptions);
+
+    // Solve the CNF formula under the assumption that the literals of 'cube' are true. The
+    // search gives up after 'conflictBudget' conflicts, in which case the solver is not solved.
+    static constexpr std::size_t noBudget = static_cast<std::size_t>(-1);
+    bool solve(const std::vector<Literal> & cube, std::size_t conflictBudget);
+
+    // The value of a DIMACS literal in the model found by the last call to 'solve'.
+    bool modelValue(int literal) const;
+
+    // Is the DIMACS literal one of the assumptions that the last call to 'solve' found to
+    // contradict the formula? Only those assumptions are needed to refute the others.
+    bool failed(int assumption) const;
+
+    // Select the literal to split a cube, a conjunction of literals, on. Each of the most
+    // promising free variables under the cube is asserted both ways and propagated, and the
+    // one whose two branches assign the most literals is chosen. A branch that leads to a
+    // conflict is a failed literal, so the other branch is added to the cube. Returns false
+    // if the cube has been refuted. 'split' is noLiteral if the cube assigns every variable.
+    bool lookahead(std::vector<Literal> & cube, Literal & split);
+
+    // Make a running 'solve' return as soon as possible without an answer, and later calls return
+    // at once. May be called from another thread or from a signal handler, as it only stores to
+    // a lock-free atomic flag.
+    void interrupt() { interrupted.store(true, std::memory_order_relaxed); }
+
+    // Interrupt every solver of the process, including those created later. May be called from
+    // a signal handler.
+    static void interruptAll() { allInterrupted.store(true, std::memory_order_relaxed); }
+
+    Limit limitReached() const { return limit; }
+
+    // Exchange learned clauses with other solvers running in parallel on the same formula.
+    void shareClauses(ClauseBuffer * exports, const std::vector<const ClauseBuffer *> & imports);
+
+    // Has the formula been found satisfiable or unsatisfiable?
+    bool isSolved() const { return state != MaphSAT::State::UNKNOWN; }
+
+    const PhaseTimes & phaseTimes() const { return times; }
+
+    const Statistics & statistics() const { return stats; }
+
+    // Print the statistics of the search as DIMACS comment lines. The phase times are included
+    // if they have been measured, and the time spent in the hot functions if profiling.
+    void printStatistics(std::ostream &) const;
+
     // Print the current state of the SAT solver.
     friend std::ostream & operator<<(std::ostream &, const MaphSAT &);
 
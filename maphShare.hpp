@@ -0,0 +1,85 @@
+#ifndef __MAPHSHARE_HPP__
+#define __MAPHSHARE_HPP__
+
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+#include "maphClause.hpp"
+
+// A ring buffer of learned clauses that one solver exports and any number of other solvers
+// import without locks. Each clause is stored as its size followed by its literals. Readers
+// that fall more than the capacity behind lose the clauses they have missed.
+class ClauseBuffer {
+
+public:
+
+    // Longer clauses are not exported.
+    static constexpr std::size_t maximumSize = 255;
+
+private:
+
+    static constexpr std::size_t capacity = 1 << 16;
+
+    std::atomic<Literal> words[capacity];
+
+    // The number of words written so far. 'reserved' is advanced before a clause is written
+    // and 'head' after, so that a reader can tell whether the words it has read were
+    // overwritten while it was reading them.
+    std::atomic<std::size_t> reserved;
+    std::atomic<std::size_t> head;
+
+public:
+
+    ClauseBuffer() : words(), reserved(0), head(0) {}
+
+    // Append a clause. Only the exporting solver may call this.
+    template <typename Iterator>
+    void push(Iterator first, Iterator last) {
+        const std::size_t size = last - first;
+        if (size > maximumSize)
+            return;
+        std::size_t position = head.load(std::memory_order_relaxed);
+        reserved.store(position + size + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        words[position++ % capacity].store(size, std::memory_order_relaxed);
+        for (; first != last; ++first)
+            words[position++ % capacity].store(*first, std::memory_order_relaxed);
+        head.store(position, std::memory_order_release);
+    }
+
+    // Read the next clause after 'position' into 'clause' and advance 'position' past it.
+    // Returns false if no complete clause is available.
+    bool read(std::size_t & position, std::vector<Literal> & clause) const {
+        const std::size_t written = head.load(std::memory_order_acquire);
+        if (position == written)
+            return false;
+        // Skip the clauses that have been overwritten.
+        if (written - position > capacity - maximumSize - 1) {
+            position = written;
+            return false;
+        }
+
+        const std::size_t size = words[position % capacity].load(std::memory_order_relaxed);
+        // A size word that is being overwritten may hold a literal, so it is checked before
+        // the clause is resized to it.
+        if (size > maximumSize) {
+            position = head.load(std::memory_order_acquire);
+            return false;
+        }
+        clause.resize(size);
+        for (std::size_t i = 0; i < size; ++i)
+            clause[i] = words[(position + 1 + i) % capacity].load(std::memory_order_relaxed);
+
+        // Discard the clause if a clause that is being written may have overwritten it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (reserved.load(std::memory_order_relaxed) - position > capacity) {
+            position = head.load(std::memory_order_acquire);
+            return false;
+        }
+        position += size + 1;
+        return true;
+    }
+};
+
+#endif
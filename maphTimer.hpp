@@ -0,0 +1,73 @@
+#ifndef __MAPHTIMER_HPP__
+#define __MAPHTIMER_HPP__
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Profiling builds ('make profile') count the cycles spent in the functions on the hot path of
+// the search. In other builds the cycle timers compile to nothing.
+#ifdef MAPH_PROFILE
+constexpr bool profiling = true;
+#else
+constexpr bool profiling = false;
+#endif
+
+// Reads the time stamp counter of the processor, or the steady clock in nanoseconds where
+// there is none. Either way the ticks are converted to seconds by comparing them with the
+// steady clock over a longer period.
+inline std::uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Adds the time from its construction to its destruction to a number of seconds. A timer
+// that is not enabled does not read the clock at all.
+class ScopedTimer {
+
+    double * seconds;
+    std::chrono::steady_clock::time_point start;
+
+public:
+
+    ScopedTimer(double & total, bool enabled) :
+        seconds(enabled ? &total : nullptr),
+        start(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+    ~ScopedTimer() {
+        if (seconds != nullptr)
+            *seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer & operator=(const ScopedTimer &) = delete;
+};
+
+// Adds the cycles from its construction to its destruction to a total when profiling.
+// Reading the time stamp counter is cheap enough to do around every call of a hot function.
+class CycleTimer {
+
+    std::uint64_t & total;
+    std::uint64_t start;
+
+public:
+
+    explicit CycleTimer(std::uint64_t & total) : total(total), start(profiling ? readCycles() : 0) {}
+
+    ~CycleTimer() {
+        if (profiling)
+            total += readCycles() - start;
+    }
+
+    CycleTimer(const CycleTimer &) = delete;
+    CycleTimer & operator=(const CycleTimer &) = delete;
+};
+
+#endif